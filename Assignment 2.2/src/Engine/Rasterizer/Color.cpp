@@ -1,43 +1,51 @@
 #include <AEEngine.h>
 #include "Color.h"
+#include "ColorSpace.h"
+#include <emmintrin.h>
 namespace Rasterizer
 {
-	// ------------------------------------------------------------------------
-	/// \fn		Default & custom
-	/// \brief	
-	Color::Color()
-		: r(0.0f)
-		, g(0.0f)
-		, b(0.0f)
-		, a(1.0f)
-	{}
+	// colors converted per EncodeColors/DecodePixels call by the batch
+	// functions (scratch on the stack)
+	static const u32 cBatchSize = 64;
 
 	// ------------------------------------------------------------------------
-	/// \fn		Default & custom
-	/// \brief	
-	Color::Color(f32 rr, f32 gg, f32 bb, f32 aa)
-		: r(rr)
-		, g(gg)
-		, b(bb)
-		, a(aa)
-	{}
+	/// \fn		SwapRedBlue
+	/// \brief	RGBA bytes <-> ARGB u32: both keep alpha and green in place and
+	///			exchange the other two bytes. 4 values at a time.
+	static void SwapRedBlue(const void* in, u32 count, void* out)
+	{
+		const u8* src = static_cast<const u8*>(in);
+		u8* dst = static_cast<u8*>(out);
+		const __m128i keep = _mm_set1_epi32(s32(0xFF00FF00));
+		const __m128i low = _mm_set1_epi32(0xFF);
+
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+			__m128i s = _mm_or_si128(_mm_and_si128(v, keep),
+				_mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, low), 16), _mm_and_si128(_mm_srli_epi32(v, 16), low)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), s);
+		}
+		for (; i < count; ++i)
+		{
+			const u8* p = src + i * 4;
+			u8* q = dst + i * 4;
+			u8 t = p[0];
+			q[1] = p[1];
+			q[3] = p[3];
+			q[0] = p[2];
+			q[2] = t;
+		}
+	}
 
 	// ------------------------------------------------------------------------
 	/// \fn		FromU32
 	/// \brief	Set the color to the u32 color in format ARGB hex
 	Color & Color::FromU32(u32 color) // custom constructor
 	{
-		// decompose
-		u32 aa = (color & (0x000000FF << 24)) >> 24;
-		u32 rr = (color & (0x000000FF << 16)) >> 16;
-		u32 gg = (color & (0x000000FF << 8)) >> 8;
-		u32 bb = color & 0x000000FF;
-
-		// float
-		r = (f32)rr / 255.0f;
-		g = (f32)gg / 255.0f;
-		b = (f32)bb / 255.0f;
-		a = (f32)aa / 255.0f;
+		// decompose to floats, in the current color space
+		UnpackColors(&color, 1, this);
 
 		// return the modified color
 		return *this;
@@ -48,63 +56,38 @@ namespace Rasterizer
 	/// \brief	returns u32 color from this color.
 	u32 Color::ToU32()	const // conversion operator
 	{
-		// convert each element to range [0,255]
-		u32 aa = (a < 0.0f) ? (0) : ((a > 1.0f) ? (255) : u32(a*255.0f));
-		u32 rr = (r < 0.0f) ? (0) : ((r > 1.0f) ? (255) : u32(r*255.0f));
-		u32 gg = (g < 0.0f) ? (0) : ((g > 1.0f) ? (255) : u32(g*255.0f));
-		u32 bb = (b < 0.0f) ? (0) : ((b > 1.0f) ? (255) : u32(b*255.0f));
-
-		// pack
-		u32 c = (aa << 24) | (rr << 16) | (gg << 8) | bb;
+		// saturate to [0,255] in the current color space and pack
+		u32 c;
+		PackColors(this, 1, &c);
 		return c;
 	}
 
-	Color Color::operator *(const float & sc)const 
-	{
-		return Color(r*sc, g*sc, b*sc, a*sc); 
-	}
-	Color& Color::operator *=(const float & sc) 
-	{
-		return *this = *this * sc; 
-	}
-	Color Color::operator +(const Color & rhs)const  
-	{
-		return Color(
-			r + rhs.r,
-			g + rhs.g,
-			b + rhs.b,
-			a + rhs.a);
-	}
-	Color& Color::operator += (const Color & rhs)
-	{
-		return *this = *this + rhs;
-	}
-	Color Color::operator-(const Color& rhs) const
-	{
-		return Color(
-			r - rhs.r,
-			g - rhs.g,
-			b - rhs.b,
-			a - rhs.a);
-	}
-	Color& Color::operator-=(const Color& rhs)
-	{
-		return *this = *this - rhs;
-	}
-	Color Color::operator-() const
-	{
-		return Color(-r,-g,-b,-a);
-	}
-	Color Color::operator*(const Color& rhs) const
+	// ------------------------------------------------------------------------
+	/// \fn		PackColors
+	/// \brief	EncodeColors (SSE clamp and scale) followed by the RGBA to
+	///			ARGB swizzle, in batches of cBatchSize.
+	void PackColors(const Color* colors, u32 count, u32* argb)
 	{
-		return Color(
-			r * rhs.r,
-			g * rhs.g,
-			b * rhs.b,
-			a * rhs.a);
+		u8 rgba[cBatchSize * 4];
+		for (u32 i = 0; i < count; i += cBatchSize)
+		{
+			u32 n = min(cBatchSize, count - i);
+			EncodeColors(colors + i, n, rgba);
+			SwapRedBlue(rgba, n, argb + i);
+		}
 	}
-	Color& Color::operator*=(const Color& rhs)
+
+	// ------------------------------------------------------------------------
+	/// \fn		UnpackColors
+	/// \brief	ARGB to RGBA swizzle followed by DecodePixels.
+	void UnpackColors(const u32* argb, u32 count, Color* colors)
 	{
-		return *this = *this * rhs;
+		u8 rgba[cBatchSize * 4];
+		for (u32 i = 0; i < count; i += cBatchSize)
+		{
+			u32 n = min(cBatchSize, count - i);
+			SwapRedBlue(argb + i, n, rgba);
+			DecodePixels(rgba, n, colors + i);
+		}
 	}
-}// namespace Rasterizer
\ No newline at end of file
+}// namespace Rasterizer
@@ -1,9 +1,17 @@
 #ifndef CS200_COLOR_H_
 #define CS200_COLOR_H_
 
+#include <xmmintrin.h>	// SSE
+
 namespace Rasterizer
 {
 #pragma warning (disable:4201) // nameless struct warning
+	/// -----------------------------------------------------------------------
+	/// \struct	Color
+	/// \brief	Four floats (no alignment requirement, so the layout and the
+	///			by value calls stay the same). The arithmetic works on all
+	///			channels at once in an SSE register through Get/Set and is
+	///			inlined so chains of operations stay in registers.
 	struct Color
 	{
 		union
@@ -17,6 +25,10 @@ namespace Rasterizer
 
 		Color();
 		Color(f32 rr, f32 gg, f32 bb, f32 aa = 1.0f);
+		explicit Color(__m128 m);
+
+		__m128	Get() const;
+		void	Set(__m128 m);
 		
 		Color	operator *(const float & sc) const;
 		Color&	operator *=(const float & sc);
@@ -31,6 +43,37 @@ namespace Rasterizer
 		u32    ToU32()const;
 	};
 #pragma warning (default:4201) // nameless struct warning
+
+	/// -----------------------------------------------------------------------
+	/// \fn		PackColors
+	/// \brief	Converts count colors to ARGB (the ToU32 format), channels
+	///			saturated to [0, 1], in the current color space.
+	void PackColors(const Color* colors, u32 count, u32* argb);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		UnpackColors
+	/// \brief	Converts count ARGB values to colors (the FromU32 format).
+	void UnpackColors(const u32* argb, u32 count, Color* colors);
+
+	// ------------------------------------------------------------------------
+	// Inline implementation
+
+	inline Color::Color() : r(0.0f), g(0.0f), b(0.0f), a(1.0f) {}
+	inline Color::Color(f32 rr, f32 gg, f32 bb, f32 aa) : r(rr), g(gg), b(bb), a(aa) {}
+	inline Color::Color(__m128 m) { Set(m); }
+
+	inline __m128	Color::Get() const		{ return _mm_loadu_ps(v); }
+	inline void		Color::Set(__m128 m)	{ _mm_storeu_ps(v, m); }
+
+	inline Color	Color::operator *(const float & sc) const	{ return Color(_mm_mul_ps(Get(), _mm_set1_ps(sc))); }
+	inline Color&	Color::operator *=(const float & sc)		{ Set(_mm_mul_ps(Get(), _mm_set1_ps(sc))); return *this; }
+	inline Color	Color::operator +(const Color& rhs) const	{ return Color(_mm_add_ps(Get(), rhs.Get())); }
+	inline Color&	Color::operator +=(const Color& rhs)		{ Set(_mm_add_ps(Get(), rhs.Get())); return *this; }
+	inline Color	Color::operator -(const Color& rhs) const	{ return Color(_mm_sub_ps(Get(), rhs.Get())); }
+	inline Color&	Color::operator -=(const Color& rhs)		{ Set(_mm_sub_ps(Get(), rhs.Get())); return *this; }
+	inline Color	Color::operator -() const					{ return Color(_mm_xor_ps(Get(), _mm_set1_ps(-0.0f))); }
+	inline Color	Color::operator *(const Color& rhs) const	{ return Color(_mm_mul_ps(Get(), rhs.Get())); }
+	inline Color&	Color::operator *=(const Color& rhs)		{ Set(_mm_mul_ps(Get(), rhs.Get())); return *this; }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,182 @@
+// ----------------------------------------------------------------------------
+// File Name		:	ColorSpace.cpp
+// Purpose			:	Conversions between Color and the 8 bit frame buffer
+//						channels, in gamma space or linear/sRGB. The sRGB
+//						curve is baked into two tables at startup.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include <emmintrin.h>
+#include <cmath>
+
+namespace Rasterizer
+{
+	// entries of the encoding table, enough that every byte is reachable
+	// from the dark end of the curve
+	static const u32 cEncodeEntries = cSRGBEncodeEntries;
+
+	// ------------------------------------------------------------------------
+	/// \struct	SRGBTables
+	/// \brief	Both tables, filled once before main.
+	static struct SRGBTables
+	{
+		SRGBTables()
+		{
+			for (u32 i = 0; i < 256; ++i)
+			{
+				f32 c = i / 255.0f;
+				mDecode[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (u32 i = 0; i < cEncodeEntries; ++i)
+			{
+				f32 l = i / f32(cEncodeEntries - 1);
+				f32 c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+				mEncode[i] = u8(c * 255.0f + 0.5f);
+			}
+		}
+
+		f32	mDecode[256];
+		u8	mEncode[cEncodeEntries];
+	} sTables;
+
+	static EColorSpace sColorSpace = eCS_GAMMA;
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetColorSpace / GetColorSpace
+	/// \brief	Mode used by every Color <-> u8 conversion.
+	void SetColorSpace(EColorSpace space)
+	{
+		if (space < eCS_COUNT)
+			sColorSpace = space;
+	}
+	EColorSpace GetColorSpace()
+	{
+		return sColorSpace;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		LinearToSRGB8
+	/// \brief	4096 entry table lookup, the input is clamped to [0, 1].
+	u8 LinearToSRGB8(f32 value)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return sTables.mEncode[u32(value * (cEncodeEntries - 1) + 0.5f)];
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SRGB8ToLinear
+	/// \brief	256 entry table lookup.
+	f32 SRGB8ToLinear(u8 value)
+	{
+		return sTables.mDecode[value];
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		GetSRGBEncodeTable
+	/// \brief	The cSRGBEncodeEntries entry encoding table.
+	const u8* GetSRGBEncodeTable()
+	{
+		return sTables.mEncode;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		EncodeChannel
+	/// \brief	Single color channel (not alpha) in the current color space.
+	u8 EncodeChannel(f32 value)
+	{
+		if (sColorSpace == eCS_SRGB)
+			return LinearToSRGB8(value);
+		return value < 0.0f ? 0 : (value > 1.0f ? 255 : u8(value * 255.0f));
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DecodeChannel
+	/// \brief	Single color channel (not alpha) in the current color space.
+	f32 DecodeChannel(u8 value)
+	{
+		if (sColorSpace == eCS_SRGB)
+			return SRGB8ToLinear(value);
+		return value / 255.0f;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		EncodeColors
+	/// \brief	Clamps and scales the 4 channels at once. Gamma space packs
+	///			straight to bytes (truncating like the scalar code always
+	///			did), sRGB turns the color channels into table indices and
+	///			looks them up one by one: no gather needed.
+	void EncodeColors(const Color* colors, u32 count, u8* rgba)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		if (sColorSpace == eCS_GAMMA)
+		{
+			const __m128 scale = _mm_set1_ps(255.0f);
+
+			// 4 colors become 16 bytes with two saturating packs
+			u32 i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v[4];
+				for (u32 k = 0; k < 4; ++k)
+					v[k] = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(colors[i + k].Get(), zero), one), scale));
+				__m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), packed);
+			}
+			for (; i < count; ++i)
+			{
+				__m128 c = _mm_min_ps(_mm_max_ps(colors[i].Get(), zero), one);
+				__m128i v = _mm_cvttps_epi32(_mm_mul_ps(c, scale));
+				v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+				s32 packed = _mm_cvtsi128_si32(v);
+				memcpy(rgba + i * 4, &packed, 4);
+			}
+			return;
+		}
+
+		// rgb become rounded table indices, alpha is scaled to 255
+		const __m128 scale = _mm_setr_ps(f32(cEncodeEntries - 1), f32(cEncodeEntries - 1), f32(cEncodeEntries - 1), 255.0f);
+		const __m128 bias = _mm_setr_ps(0.5f, 0.5f, 0.5f, 0.0f);
+		for (u32 i = 0; i < count; ++i)
+		{
+			__m128 c = _mm_min_ps(_mm_max_ps(colors[i].Get(), zero), one);
+			s32 idx[4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(idx), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), bias)));
+
+			u8* out = rgba + i * 4;
+			out[0] = sTables.mEncode[idx[0]];
+			out[1] = sTables.mEncode[idx[1]];
+			out[2] = sTables.mEncode[idx[2]];
+			out[3] = u8(idx[3]);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DecodePixels
+	/// \brief	Gamma space widens every pixel to 4 floats and scales by
+	///			1/255, sRGB looks the color channels up in the 256 entry table.
+	void DecodePixels(const u8* rgba, u32 count, Color* colors)
+	{
+		if (sColorSpace == eCS_GAMMA)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+			for (u32 i = 0; i < count; ++i)
+			{
+				s32 packed;
+				memcpy(&packed, rgba + i * 4, 4);
+				__m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+				colors[i].Set(_mm_mul_ps(_mm_cvtepi32_ps(p), scale));
+			}
+			return;
+		}
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			const u8* p = rgba + i * 4;
+			colors[i] = Color(sTables.mDecode[p[0]], sTables.mDecode[p[1]], sTables.mDecode[p[2]], p[3] / 255.0f);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef CS200_COLOR_SPACE_H_
+#define CS200_COLOR_SPACE_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \enum	EColorSpace
+	/// \brief	How Color values map to the 8 bit channels of the frame buffer.
+	///			eCS_GAMMA stores value * 255 (the original behavior, colors
+	///			are interpolated in gamma space). eCS_SRGB treats Color as
+	///			linear and encodes it to sRGB, so interpolation happens in
+	///			linear space. Alpha is always linear.
+	enum EColorSpace { eCS_GAMMA, eCS_SRGB, eCS_COUNT };
+
+	void		SetColorSpace(EColorSpace space);
+	EColorSpace	GetColorSpace();
+
+	/// -----------------------------------------------------------------------
+	/// \fn		LinearToSRGB8 / SRGB8ToLinear
+	/// \brief	Table based conversions: 4096 entries for encoding (the input
+	///			is clamped to [0, 1]), 256 for decoding. No powf per call.
+	u8	LinearToSRGB8(f32 value);
+	f32	SRGB8ToLinear(u8 value);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		GetSRGBEncodeTable
+	/// \brief	The encoding table itself, cSRGBEncodeEntries entries mapping
+	///			linear [0, 1] to sRGB bytes. For integer pipelines that
+	///			already have the index.
+	static const u32 cSRGBEncodeEntries = 4096;
+	const u8* GetSRGBEncodeTable();
+
+	/// -----------------------------------------------------------------------
+	/// \fn		EncodeColors
+	/// \brief	Converts count colors to RGBA8 bytes in the current color
+	///			space. Clamping and scaling are done 4 channels at a time with
+	///			SSE, the sRGB curve is a table lookup per channel.
+	void EncodeColors(const Color* colors, u32 count, u8* rgba);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DecodePixels
+	/// \brief	Converts count RGBA8 pixels to colors in the current color
+	///			space.
+	void DecodePixels(const u8* rgba, u32 count, Color* colors);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		EncodeChannel / DecodeChannel
+	/// \brief	Single color channel (not alpha) in the current color space.
+	u8	EncodeChannel(f32 value);
+	f32	DecodeChannel(u8 value);
+}
+
+#endif
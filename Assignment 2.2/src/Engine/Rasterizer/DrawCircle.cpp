@@ -71,12 +71,16 @@ namespace Rasterizer {
 		FrameBuffer::SetPixel(cX + y, cY - x, c);
 	}
 
-	void DrawCircleAlgebraic(const AEVec2& center, float radius, const Color& c)
+	// ------------------------------------------------------------------------
+	/// \fn		CircleAlgebraic
+	/// \brief	DrawCircleAlgebraic for one rounding policy.
+	template <typename R>
+	static void CircleAlgebraic(R, const AEVec2& center, float radius, const Color& c)
 	{
 		//y = center.y +- sqrt(radius*radius - (center.x + radius
 
-		int xCenter = Round(center.x);
-		int yCenter = Round(center.y);
+		int xCenter = R::Apply(center.x);
+		int yCenter = R::Apply(center.y);
 
 		f32 cut_off = sqrtf(2) / 2.0f;
 
@@ -105,33 +109,81 @@ namespace Rasterizer {
 
 		}*/
 
-		for (int x = 0; x <= Round(cut_off * radius); x++)
+		for (int x = 0; x <= R::Apply(cut_off * radius); x++)
 		{
-			int y = Round(sqrtf(radius * radius - x * x));
+			int y = R::Apply(sqrtf(radius * radius - x * x));
 			SetPixelEightWay(xCenter, yCenter, x, y, c);
 		}
 	}
 
-	void DrawCircleParametric(const AEVec2& center, float radius, const Color& c)
+	void DrawCircleAlgebraic(const AEVec2& center, float radius, const Color& c)
+	{
+		//The rounding mode is resolved once, not per pixel
+		DispatchRoundMethod([&](auto rounding) { CircleAlgebraic(rounding, center, radius, c); });
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		CircleParametric
+	/// \brief	DrawCircleParametric for one rounding policy.
+	template <typename R>
+	static void CircleParametric(R, const AEVec2& center, float radius, const Color& c)
 	{
-		int xCenter = Round(center.x);
-		int yCenter = Round(center.y);
+		int xCenter = R::Apply(center.x);
+		int yCenter = R::Apply(center.y);
 
 		f32 step = PI / (4.0f * sCirclePrecision * sCirclePrecision);
 
 		for (f32 angle = 0.0f; angle <= PI/4.0f; angle += step)
 		{
-			int x = Round(cosf(angle) * radius);
-			int y = Round(sinf(angle) * radius);
+			int x = R::Apply(cosf(angle) * radius);
+			int y = R::Apply(sinf(angle) * radius);
 			SetPixelEightWay(xCenter, yCenter, x, y, c);
 		}
 	}
 
+	void DrawCircleParametric(const AEVec2& center, float radius, const Color& c)
+	{
+		//The rounding mode is resolved once, not per pixel
+		DispatchRoundMethod([&](auto rounding) { CircleParametric(rounding, center, radius, c); });
+	}
+
 	// Challenge 1
 	void DrawCircleParametricInc(const AEVec2& center, float radius, const Color& c){}
 
 	// Challenge 2
-	void FillCircle(const AEVec2& center, float radius, const Color& c){}
+	// Fills the pixels whose centers are inside the circle, one span per row
+	void FillCircle(const AEVec2& center, float radius, const Color& c)
+	{
+		if (!(radius > 0.0f))
+			return;
+
+		u32 pixel;
+		EncodeColors(&c, 1, reinterpret_cast<u8*>(&pixel));
+		FillCirclePixel(center, radius, pixel);
+	}
+
+	// FillCircle with an already encoded pixel (see FillSpan)
+	void FillCirclePixel(const AEVec2& center, float radius, u32 pixel)
+	{
+		if (!(radius > 0.0f))
+			return;
+
+		//Rows whose centers are inside, limited to the bound view
+		s32 viewTop = s32(FrameBuffer::GetOriginY());
+		s32 yBegin = max(FastFloor(center.y - radius - 0.5f) + 1, viewTop);
+		s32 yEnd = min(FastFloor(center.y + radius - 0.5f) + 1, viewTop + s32(FrameBuffer::GetHeight()));
+
+		f32 r2 = radius * radius;
+		for (s32 y = yBegin; y < yEnd; y++)
+		{
+			//Half width of the circle at the row center
+			f32 dy = f32(y) + 0.5f - center.y;
+			f32 dx = sqrtf(max(r2 - dy * dy, 0.0f));
+
+			//Pixels with centers in [cx - dx, cx + dx)
+			FillSpan(FastFloor(center.x - dx + 0.5f), FastFloor(center.x + dx + 0.5f), y, pixel);
+		}
+	}
 
 	// Challenge 3
 	void FillRing(const AEVec2 & center, float outerRadius, float innerRadius, const Color & c){}
@@ -188,10 +240,11 @@ namespace Rasterizer {
 
 	void SetPixelFourWay(u32 cX, u32 cY, u32 x, u32 y, const Color& c)
 	{
-		FrameBuffer::SetPixel(Round(cX + x), Round(cY + y), c);
-		FrameBuffer::SetPixel(Round(cX - x), Round(cY + y), c);
-		FrameBuffer::SetPixel(Round(cX + x), Round(cY - y), c);
-		FrameBuffer::SetPixel(Round(cX - x), Round(cY - y), c);
+		//already integers, no rounding needed
+		FrameBuffer::SetPixel(cX + x, cY + y, c);
+		FrameBuffer::SetPixel(cX - x, cY + y, c);
+		FrameBuffer::SetPixel(cX + x, cY - y, c);
+		FrameBuffer::SetPixel(cX - x, cY - y, c);
 	}
 
 	void DrawEllipseAlgebraic(const AEVec2& center, float A, float B, const Color& c)
@@ -216,21 +269,31 @@ namespace Rasterizer {
 		}
 	}
 
-	void DrawEllipseParametric(const AEVec2& center, float A, float B, const Color& c)
+	// ------------------------------------------------------------------------
+	/// \fn		EllipseParametric
+	/// \brief	DrawEllipseParametric for one rounding policy.
+	template <typename R>
+	static void EllipseParametric(R, const AEVec2& center, float A, float B, const Color& c)
 	{
-		int xCenter = Round(center.x);
-		int yCenter = Round(center.y);
+		int xCenter = R::Apply(center.x);
+		int yCenter = R::Apply(center.y);
 
 		f32 step = PI / (4.0f * sCirclePrecision * sCirclePrecision);
 
 		for (f32 angle = 0.0f; angle <= PI / 2.0f; angle += step)
 		{
-			int x = Round(cosf(angle) * A);
-			int y = Round(sinf(angle) * B);
+			int x = R::Apply(cosf(angle) * A);
+			int y = R::Apply(sinf(angle) * B);
 			SetPixelFourWay(xCenter, yCenter, x, y, c);
 		}
 	}
 
+	void DrawEllipseParametric(const AEVec2& center, float A, float B, const Color& c)
+	{
+		//The rounding mode is resolved once, not per pixel
+		DispatchRoundMethod([&](auto rounding) { EllipseParametric(rounding, center, A, B, c); });
+	}
+
 	// Challenge 1
 	void DrawEllipseParametricInc(const AEVec2& center, float A, float B, const Color& c){}
 
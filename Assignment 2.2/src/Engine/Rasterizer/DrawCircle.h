@@ -24,6 +24,7 @@ namespace Rasterizer {
 
 	// Challenge 2
 	void FillCircle(const AEVec2& center, float radius, const Color& c);
+	void FillCirclePixel(const AEVec2& center, float radius, u32 pixel);
 
 	// Challenge 3
 	void FillRing(const AEVec2 & center, float outerRadius, float innerRadius, const Color & c);
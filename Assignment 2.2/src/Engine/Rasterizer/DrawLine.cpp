@@ -30,6 +30,13 @@ namespace Rasterizer
 	/// \brief	Wrapper function, draws a line using the current method. 
 	void DrawLine(const AEVec2& p1, const AEVec2& p2, const Color& c)
 	{
+		//Anti-aliased lines have no aliased special cases
+		if (sDLMethod == eDL_WU)
+		{
+			DrawLineWu(p1, p2, c);
+			return;
+		}
+
 		//chek for simple cases
 		int dX = Round(p2.x - p1.x);
 		int dY = Round(p2.y - p1.y);
@@ -59,15 +66,24 @@ namespace Rasterizer
 			case eDL_BRESENHAM:
 				DrawLineBresenham(p1, p2, c);
 				break;
+			case eDL_RUN_SLICE:
+				DrawLineRunSlice(p1, p2, c);
+				break;
+			case eDL_DOUBLE_STEP:
+				DrawLineDoubleStep(p1, p2, c);
+				break;
+			case eDL_WU:
+				DrawLineWu(p1, p2, c);
+				break;
 			}
 		}
 	}
 
-	/// @TODO
 	// ------------------------------------------------------------------------
-	/// \fn		DrawLineNaive
-	/// \brief	Draws a line using the naive algorithm presented in class, based on the explicit line equation
-	void DrawLineNaive(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	/// \fn		LineNaive
+	/// \brief	DrawLineNaive for one rounding policy.
+	template <typename R>
+	static void LineNaive(R, const AEVec2& p1, const AEVec2& p2, const Color& c)
 	{
 		float dX = (p2.x - p1.x);		//Difference on x and y
 		float dY = (p2.y - p1.y);
@@ -78,37 +94,47 @@ namespace Rasterizer
 		if (abs(m) < 1.0f)
 		{
 			int step_x = dX > 0 ? 1 : -1;		//Change of x
-			int sX = Round(p1.x);				//X value of first point
-			int eX = Round(p2.x) + step_x;		//X value of last point
+			int sX = R::Apply(p1.x);				//X value of first point
+			int eX = R::Apply(p2.x) + step_x;		//X value of last point
 
 			//Add difference to x, and calculate y with the slope
 			for (int x = sX; x != eX; x += step_x)
 			{
 				f32 y = m * x + b;
-				FrameBuffer::SetPixel(x, Round(y), c);
+				FrameBuffer::SetPixel(x, R::Apply(y), c);
 			}
 		}
 		else
 		{
 			int step_y = dY > 0 ? 1 : -1;		//Change of y
-			int sY = Round(p1.y);				//Y value of first point
-			int eY = Round(p2.y) + step_y;		//Y value of last point
+			int sY = R::Apply(p1.y);				//Y value of first point
+			int eY = R::Apply(p2.y) + step_y;		//Y value of last point
 			f32 mInv = 1.0f / m;				//Inverse of the slope to avoid dividing
 
 			//Add difference to y, and calculate x with the slope
 			for (int y = sY; y != eY; y += step_y)
 			{
 				f32 x = (y - b) * mInv;
-				FrameBuffer::SetPixel(Round(x), y, c);
+				FrameBuffer::SetPixel(R::Apply(x), y, c);
 			}
 		}
 	}
 
 	/// @TODO
 	// ------------------------------------------------------------------------
-	/// \fn		DrawLineDDA
-	/// \brief	Draws a line using the DDA algorithm presented in class.
-	void DrawLineDDA(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	/// \fn		DrawLineNaive
+	/// \brief	Draws a line using the naive algorithm presented in class, based on the explicit line equation
+	void DrawLineNaive(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	{
+		//The rounding mode is resolved once, not per pixel
+		DispatchRoundMethod([&](auto rounding) { LineNaive(rounding, p1, p2, c); });
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		LineDDA
+	/// \brief	DrawLineDDA for one rounding policy.
+	template <typename R>
+	static void LineDDA(R, const AEVec2& p1, const AEVec2& p2, const Color& c)
 	{
 		//explicit line equation to draw the generic line
 
@@ -122,14 +148,14 @@ namespace Rasterizer
 		{
 			int step_x = dX > 0 ? 1 : -1;				//Change of y and x
 			f32 step_y = dY > 0 ? abs(m) : -abs(m);
-			int sX = Round(p1.x);						//X value of first point
-			int eX = Round(p2.x) + step_x;				//X value of last point
+			int sX = R::Apply(p1.x);						//X value of first point
+			int eX = R::Apply(p2.x) + step_x;				//X value of last point
 
 			//Add difference to x and y
 			f32 y = p1.y;
 			for (int x = sX; x != eX; x += step_x, y += step_y)
 			{
-				FrameBuffer::SetPixel(x, Round(y), c);
+				FrameBuffer::SetPixel(x, R::Apply(y), c);
 			}
 		}
 		else
@@ -137,98 +163,523 @@ namespace Rasterizer
 			f32 mInv = 1.0f / m;							//Inverse of the slope to avoid dividing
 			f32 step_x = dX > 0 ? abs(mInv) : -abs(mInv);	//Change of y and x
 			int step_y = dY > 0 ? 1 : -1;
-			int sY = Round(p1.y);							//Y value of first point
-			int eY = Round(p2.y) + step_y;					//Y value of last point
+			int sY = R::Apply(p1.y);							//Y value of first point
+			int eY = R::Apply(p2.y) + step_y;					//Y value of last point
 
 			//Add difference to x and y
 			f32 x = p1.x;
 			for (int y = sY; y != eY; y += step_y, x += step_x)
 			{
-				FrameBuffer::SetPixel(Round(x), y, c);
+				FrameBuffer::SetPixel(R::Apply(x), y, c);
 			}
 		}
 	}
 
+	/// @TODO
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineDDA
+	/// \brief	Draws a line using the DDA algorithm presented in class.
+	void DrawLineDDA(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	{
+		//The rounding mode is resolved once, not per pixel
+		DispatchRoundMethod([&](auto rounding) { LineDDA(rounding, p1, p2, c); });
+	}
+
+	// writes the pixels of a LineWalk in one color (RGBA bytes)
+	typedef void (*LineWalker)(const LineWalk& walk, u32 pixel);
+
+	// ------------------------------------------------------------------------
+	/// \fn		WalkBresenham
+	/// \brief	Writes the pixels of an integer line walk, one per step.
+	static void WalkBresenham(const LineWalk& walk, u32 pixel)
+	{
+		//Every pixel is a store and a step along the major axis. The minor
+		//step is masked in instead of branched on: carry is -1 when the
+		//error crossed 0 and 0 otherwise
+		u8* p = walk.mPixel;
+		s32 error = walk.mError;
+		for (s32 i = walk.mCount; i > 0; --i)
+		{
+			memcpy(p, &pixel, 4);
+
+			error += walk.mErrorStep;
+			s32 carry = ~(error >> 31);
+			p += walk.mMajorStep + (walk.mMinorStep & carry);
+			error -= walk.mErrorReset & carry;
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FillRun
+	/// \brief	Writes count copies of pixel starting at p, step bytes apart.
+	///			Horizontal runs (step 4) are stored 4 pixels at a time.
+	static void FillRun(u8* p, s32 count, s32 step, u32 pixel)
+	{
+		if (step == 4)
+		{
+			__m128i v = _mm_set1_epi32(s32(pixel));
+			for (; count >= 4; count -= 4, p += 16)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+		}
+		for (; count > 0; --count, p += step)
+			memcpy(p, &pixel, 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		WalkRunSlice
+	/// \brief	Writes the pixels of an integer line walk, one run at a time.
+	static void WalkRunSlice(const LineWalk& walk, u32 pixel)
+	{
+		//Runs are always filled forward in memory
+		s32 runStep = abs(walk.mMajorStep);
+
+		//Straight line: one run
+		s32 dW = walk.mErrorStep;
+		if (dW == 0)
+		{
+			u8* first = walk.mMajorStep > 0 ? walk.mPixel : walk.mPixel + (walk.mCount - 1) * walk.mMajorStep;
+			FillRun(first, walk.mCount, runStep, pixel);
+			return;
+		}
+
+		//A run lasts until the error reaches 0. With F = -error, that is
+		//ceil(F / dW) pixels, and after a minor step F is back in
+		//(reset - dW, reset], so every run but the first (clipped) one is
+		//either runLow or runLow + 1 pixels long: one compare per run
+		s32 reset = walk.mErrorReset;
+		s32 runLow = reset / dW;
+		s32 f = -walk.mError;
+		s32 run = (f + dW - 1) / dW;
+
+		u8* p = walk.mPixel;
+		s32 remaining = walk.mCount;
+		while (remaining > 0)
+		{
+			run = min(run, remaining);
+			u8* first = walk.mMajorStep > 0 ? p : p + (run - 1) * walk.mMajorStep;
+			FillRun(first, run, runStep, pixel);
+
+			//Past the run and one minor step
+			p += run * walk.mMajorStep + walk.mMinorStep;
+			remaining -= run;
+			f += reset - run * dW;
+			run = runLow + (f > runLow * dW ? 1 : 0);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		WalkDoubleStep
+	/// \brief	Writes the pixels of an integer line walk from both ends.
+	static void WalkDoubleStep(const LineWalk& walk, u32 pixel)
+	{
+		//State at the last visible pixel. Going forward the error is
+		//num - den * (q + 1), going backward it is kept as num - den * q,
+		//which lives in [0, den) and takes a minor step when it drops below 0
+		s32 den = walk.mErrorReset;
+		s64 t = s64(walk.mError) + s64(walk.mCount - 1) * walk.mErrorStep + den;
+		s32 minorSteps = s32(t / den);
+		s32 back = s32(t % den);
+
+		u8* front = walk.mPixel;
+		u8* last = walk.mPixel + (walk.mCount - 1) * walk.mMajorStep + minorSteps * walk.mMinorStep;
+		s32 error = walk.mError;
+
+		for (s32 i = walk.mCount / 2; i > 0; --i)
+		{
+			memcpy(front, &pixel, 4);
+			memcpy(last, &pixel, 4);
+
+			//Forward step, carry is -1 when the error crossed 0
+			error += walk.mErrorStep;
+			s32 carry = ~(error >> 31);
+			front += walk.mMajorStep + (walk.mMinorStep & carry);
+			error -= den & carry;
+
+			//Backward step, borrow is -1 when the error went below 0
+			back -= walk.mErrorStep;
+			s32 borrow = back >> 31;
+			last -= walk.mMajorStep + (walk.mMinorStep & borrow);
+			back += den & borrow;
+		}
+
+		//Odd count: both walks met on the middle pixel
+		if (walk.mCount & 1)
+			memcpy(front, &pixel, 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineWalk
+	/// \brief	Integer setup of one line, then walker on its pixels. The
+	///			color is converted once for the whole line.
+	static void DrawLineWalk(const AEVec2& p1, const AEVec2& p2, const Color& c, LineWalker walker)
+	{
+		LineWalk walk;
+		if (!SetupLineWalk(p1, p2, walk))
+			return;
+
+		u32 pixel;
+		EncodeColors(&c, 1, reinterpret_cast<u8*>(&pixel));
+		walker(walk, pixel);
+	}
+
 	/// @TODO
 	// ------------------------------------------------------------------------
 	/// \fn		DrawLineBresenham
 	/// \brief	Draws a line using the Bresenham algorithm presented in class.
+	///			Integer only and valid in every octant, the end points keep
+	///			their sub-pixel position (see LineWalk.h).
 	void DrawLineBresenham(const AEVec2& p1, const AEVec2& p2, const Color& c)
 	{
-		float dX = (p2.x - p1.x);		//Difference on x and y
-		float dY = (p2.y - p1.y);
-		float m = dY / dX;				//Slope of the line
+		DrawLineWalk(p1, p2, c, WalkBresenham);
+	}
 
-		int step_x = dX > 0 ? 1 : -1;	//Change of y and x
-		int step_y = dY > 0 ? 1 : -1;
-		int eX = Round(p2.x) + step_x;	//X value at last point
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineRunSlice
+	/// \brief	Same pixels as DrawLineBresenham, written one run at a time.
+	void DrawLineRunSlice(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	{
+		DrawLineWalk(p1, p2, c, WalkRunSlice);
+	}
 
-		int dP = 2 * dY - dX;			//Decision parameter
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineDoubleStep
+	/// \brief	Same pixels as DrawLineBresenham, walked from both end points.
+	void DrawLineDoubleStep(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	{
+		DrawLineWalk(p1, p2, c, WalkDoubleStep);
+	}
 
-		int x = Round(p1.x);			//Position at x and y
-		int y = Round(p1.y);
+	// ------------------------------------------------------------------------
+	/// \fn		BlendPair
+	/// \brief	Blends src over the pixels at a and b with weights wa and wb
+	///			(0 to 128). Both pixels go through one SSE register:
+	///			dst + ((src - dst) * w) >> 7 per channel.
+	static void BlendPair(u8* a, u8* b, __m128i src, s32 wa, s32 wb)
+	{
+		u32 pa, pb;
+		memcpy(&pa, a, 4);
+		memcpy(&pb, b, 4);
+
+		__m128i dst = _mm_unpacklo_epi32(_mm_cvtsi32_si128(s32(pa)), _mm_cvtsi32_si128(s32(pb)));
+		dst = _mm_unpacklo_epi8(dst, _mm_setzero_si128());
+		__m128i w = _mm_set_epi16(s16(wb), s16(wb), s16(wb), s16(wb), s16(wa), s16(wa), s16(wa), s16(wa));
+		__m128i blend = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(src, dst), w), 7);
+		__m128i out = _mm_packus_epi16(_mm_add_epi16(dst, blend), _mm_setzero_si128());
+
+		pa = u32(_mm_cvtsi128_si32(out));
+		pb = u32(_mm_cvtsi128_si32(_mm_srli_si128(out, 4)));
+		memcpy(a, &pa, 4);
+		memcpy(b, &pb, 4);
+	}
 
-		while (x != eX)
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineWu
+	/// \brief	Anti-aliased line (Xiaolin Wu). Every major column covers
+	///			the two pixels next to the line, weighted by their distance
+	///			to it, and the end columns are also weighted by how much of
+	///			them the line covers. End points are 24.8 fixed point and
+	///			the minor coordinate steps in 16.16, coverages are 8 bits.
+	///			Pixels are blended in the stored color space.
+	void DrawLineWu(const AEVec2& p1, const AEVec2& p2, const Color& c)
+	{
+		Surface view = FrameBuffer::GetSurface();
+		if (!view.mPixels || view.mWidth == 0 || view.mHeight == 0)
+			return;
+
+		//1. End points to 24.8, relative to the view and shifted half a
+		//   pixel so the pixel centers are at integer positions
+		f32 ends[4] = { p1.x * 256.0f, p1.y * 256.0f, p2.x * 256.0f, p2.y * 256.0f };
+		for (f32 e : ends)
+			if (!(fabsf(e) <= cMaxLineCoord * 256.0f))
+				return;
+		int fixed[4];
+		for (u32 i = 0; i < 4; ++i)
+			fixed[i] = FastFloor(ends[i]);
+		s32 ox = s32(FrameBuffer::GetOriginX()) * 256 + 128;
+		s32 oy = s32(FrameBuffer::GetOriginY()) * 256 + 128;
+		s32 x0 = fixed[0] - ox, y0 = fixed[1] - oy;
+		s32 x1 = fixed[2] - ox, y1 = fixed[3] - oy;
+
+		//2. Color and coverage to 7 bit weights
+		u8 rgba[4];
+		EncodeColors(&c, 1, rgba);
+		__m128i src = _mm_setr_epi16(rgba[0], rgba[1], rgba[2], 255, rgba[0], rgba[1], rgba[2], 255);
+		s32 alpha = (s32(rgba[3]) * 128 + 127) / 255;
+
+		//A zero length line covers nothing, it is drawn as the end pixel
+		//(the one the other methods plot) at full coverage
+		if (x0 == x1 && y0 == y1)
 		{
-			FrameBuffer::SetPixel(x, y, c);					//Set the pixel
-
-			//e.g.: In the case 1
-			//Choose between E or NE pixels
-			if (abs(m) < 1)
+			s32 px = Round(p1.x) - s32(FrameBuffer::GetOriginX());
+			s32 py = Round(p1.y) - s32(FrameBuffer::GetOriginY());
+			if (px >= 0 && py >= 0 && px < s32(view.mWidth) && py < s32(view.mHeight))
 			{
-				//Passes closer to NE
-				if (dP > 0)
-				{
-					y += step_y;							//Increase y
-					dP = dP + 2 * abs(dY) - 2 * abs(dX);	//Change the decision parameter
-				}
-				//Passes closer to E
-				else
-				{
-					dP = dP + 2 * abs(dY);					//Change the decision parameter
-				}
+				u8* pixel = view.GetPixel(u32(px), u32(py));
+				BlendPair(pixel, pixel, src, alpha, alpha);
+			}
+			return;
+		}
+
+		//3. Walk along the longer axis, always forward
+		bool steep = abs(y1 - y0) > abs(x1 - x0);
+		if (steep)
+		{
+			std::swap(x0, y0);
+			std::swap(x1, y1);
+		}
+		if (x0 > x1)
+		{
+			std::swap(x0, x1);
+			std::swap(y0, y1);
+		}
+		s32 majorSize = s32(steep ? view.mHeight : view.mWidth);
+		s32 minorSize = s32(steep ? view.mWidth : view.mHeight);
+		s32 majorStep = steep ? s32(view.mPitch) : 4;
+		s32 minorStep = steep ? 4 : s32(view.mPitch);
+
+		//Minor change per column, 16.16
+		s32 dx = x1 - x0;
+		s32 gradient = dx ? s32((s64(y1 - y0) << 16) / dx) : 0;
+
+		//4. Columns, with the part of the first and last ones the line
+		//   covers (8 bits)
+		s32 first = (x0 + 128) >> 8;
+		s32 last = (x1 + 128) >> 8;
+		s32 firstGap = first == last ? dx : 256 - ((x0 + 128) & 255);
+		s32 lastGap = (x1 + 128) & 255;
+
+		//Minor position (16.16) at the first column. Every other column is
+		//a whole number of gradient steps from it, so clipping does not
+		//change the coverages
+		s64 yFirst = (s64(y0) << 8) + (s64(first) * 256 - x0) * gradient / 256;
+
+		//Clip the columns to the view, and to the ones where the line is
+		//at most one pixel outside it on the minor axis
+		s32 begin = max(first, 0);
+		s32 end = min(last, majorSize - 1);
+		if (gradient != 0)
+		{
+			//the +-1 covers the rounding of the divisions
+			s64 low = -(s64(1) << 16), high = s64(minorSize) << 16;
+			s64 from = gradient > 0 ? low : high, to = gradient > 0 ? high : low;
+			s64 base = yFirst - s64(first) * gradient;
+			begin = s32(max(s64(begin), (from - base) / gradient - 1));
+			end = s32(min(s64(end), (to - base) / gradient + 1));
+		}
+		else if ((yFirst >> 16) < -1 || (yFirst >> 16) >= minorSize)
+			return;
+		if (begin > end)
+			return;
 
-				x += step_x;								//Increse x every time
+
+		s32 intery = s32(yFirst + s64(begin - first) * gradient);
+		u8* column = view.mPixels + begin * majorStep;
+		for (s32 k = begin; k <= end; ++k, intery += gradient, column += majorStep)
+		{
+			//Weight of the whole column
+			s32 weight = alpha;
+			if (k == first)
+				weight = (alpha * firstGap) >> 8;
+			else if (k == last)
+				weight = (alpha * lastGap) >> 8;
+
+			//The pixel below the line center gets the rest of its coverage
+			s32 row = intery >> 16;
+			s32 f = (intery >> 8) & 255;
+			s32 wHigh = ((f + 1) * weight) >> 8;
+			s32 wLow = ((256 - f) * weight) >> 8;
+
+			if (row >= 0 && row + 1 < minorSize)
+				BlendPair(column + row * minorStep, column + (row + 1) * minorStep, src, wLow, wHigh);
+			else if (row == -1)
+				BlendPair(column, column, src, wHigh, wHigh);
+			else if (row == minorSize - 1)
+				BlendPair(column + row * minorStep, column + row * minorStep, src, wLow, wLow);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetBatchWalker
+	/// \brief	Walker used by the batched calls for the current line method.
+	///			The float methods (naive, DDA) use Bresenham's pixels, Wu is
+	///			handled before getting here.
+	static LineWalker GetBatchWalker()
+	{
+		switch (sDLMethod)
+		{
+		case eDL_RUN_SLICE:
+			return WalkRunSlice;
+		case eDL_DOUBLE_STEP:
+			return WalkDoubleStep;
+		default:
+			return WalkBresenham;
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLines
+	/// \brief	Draws the lines p0[i] -> p1[i]. The end points of a whole
+	///			batch are converted to fixed point together, the method and
+	///			the color are resolved once per call.
+	void DrawLines(const AEVec2* p0, const AEVec2* p1, u32 count, const Color& c)
+	{
+		Surface view = FrameBuffer::GetSurface();
+		if (!view.mPixels || count == 0)
+			return;
+
+		//Anti-aliased lines have their own setup
+		if (sDLMethod == eDL_WU)
+		{
+			for (u32 i = 0; i < count; ++i)
+				DrawLineWu(p0[i], p1[i], c);
+			return;
+		}
+
+		u32 pixel;
+		EncodeColors(&c, 1, reinterpret_cast<u8*>(&pixel));
+		LineWalker walker = GetBatchWalker();
+
+		s32 x0[cLineBatch], y0[cLineBatch], x1[cLineBatch], y1[cLineBatch];
+		for (u32 begin = 0; begin < count; begin += cLineBatch)
+		{
+			u32 n = min(cLineBatch, count - begin);
+			ToLineFixed(p0 + begin, n, x0, y0);
+			ToLineFixed(p1 + begin, n, x1, y1);
+
+			LineWalk walk;
+			for (u32 i = 0; i < n; ++i)
+				if (SetupLineWalk(x0[i], y0[i], x1[i], y1[i], view, walk))
+					walker(walk, pixel);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		TrimSharedEnds
+	/// \brief	Drops the end pixels of walk (line (x0, y0) -> (x1, y1))
+	///			that another line of the chain already wrote. An end pixel is
+	///			only in the walk when the clipping kept it, which is when the
+	///			first (last) visible pixel is on the end point's major pixel.
+	static void TrimSharedEnds(LineWalk& walk, s32 x0, s32 y0, s32 x1, s32 y1, bool first, bool last)
+	{
+		s32 major = walk.mXMajor ? walk.mX : walk.mY;
+		if (last && major + walk.mMajorDir * (walk.mCount - 1) == (walk.mXMajor ? x1 : y1) >> 8)
+			--walk.mCount;
+		if (!first || walk.mCount == 0 || major != (walk.mXMajor ? x0 : y0) >> 8)
+			return;
+
+		//One step of the walk
+		walk.mError += walk.mErrorStep;
+		if (walk.mError >= 0)
+		{
+			walk.mPixel += walk.mMinorStep;
+			walk.mError -= walk.mErrorReset;
+			(walk.mXMajor ? walk.mY : walk.mX) += walk.mMinorDir;
+		}
+		walk.mPixel += walk.mMajorStep;
+		(walk.mXMajor ? walk.mX : walk.mY) += walk.mMajorDir;
+		--walk.mCount;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineChain
+	/// \brief	Draws the connected lines points[0] -> points[1] -> ... and
+	///			back to points[0] when closed. Every point is converted once
+	///			and then used as the end of one line and the start of the
+	///			next, every shared pixel is written once.
+	static void DrawLineChain(const AEVec2* points, u32 count, const Color& c, bool closed)
+	{
+		Surface view = FrameBuffer::GetSurface();
+		if (!view.mPixels || !points || count < 2)
+			return;
+
+		//Two points make one line, the walk plots the same pixels both ways
+		closed = closed && count > 2;
+
+		//Anti-aliased lines have their own setup
+		if (sDLMethod == eDL_WU)
+		{
+			for (u32 i = 0; i + 1 < count; ++i)
+				DrawLineWu(points[i], points[i + 1], c);
+			if (closed)
+				DrawLineWu(points[count - 1], points[0], c);
+			return;
+		}
+
+		u32 pixel;
+		EncodeColors(&c, 1, reinterpret_cast<u8*>(&pixel));
+		LineWalker walker = GetBatchWalker();
+
+		//A vertex pixel is written by the line ending there, so the next
+		//line skips its first pixel. That line only exists when the
+		//previous point is valid (it is still clipped like any other)
+		auto valid = [](s32 x, s32 y) { return x != cLineFixedInvalid && y != cLineFixedInvalid; };
+
+		//The last point of a batch is kept as the first of the next one
+		s32 x[cLineBatch + 1], y[cLineBatch + 1];
+		s32 firstX = 0, firstY = 0, secondX = 0, secondY = 0;
+		bool previousValid = false;
+		LineWalk walk;
+		for (u32 begin = 0; begin + 1 < count; begin += cLineBatch)
+		{
+			u32 n = min(cLineBatch + 1, count - begin);
+			ToLineFixed(points + begin, n, x, y);
+			if (begin == 0)
+			{
+				firstX = x[0], firstY = y[0];
+				secondX = x[1], secondY = y[1];
 			}
-			//e.g.: In the case 2
-			//Choose between N or NE pixels
-			else
+
+			for (u32 i = 0; i + 1 < n; ++i)
 			{
-				//Passes closer to N
-				if (dP > 0)
-				{	
-					x += step_x;							//Increse x 
-					dP = dP + 2 * abs(dX) - 2 * abs(dY);	//Change the decision parameter
-				}
-				//Passes closer to NE
-				else
+				if (SetupLineWalk(x[i], y[i], x[i + 1], y[i + 1], view, walk))
 				{
-					dP = dP + 2 * abs(dX);					//Change the decision parameter
+					TrimSharedEnds(walk, x[i], y[i], x[i + 1], y[i + 1], previousValid, false);
+					walker(walk, pixel);
 				}
+				previousValid = valid(x[i], y[i]);
+			}
 
-				y += step_y;								//Increse y every time
+			//Closing line from the very last point, points[0] was written
+			//by the first line when points[1] is valid
+			if (closed && begin + n == count && SetupLineWalk(x[n - 1], y[n - 1], firstX, firstY, view, walk))
+			{
+				TrimSharedEnds(walk, x[n - 1], y[n - 1], firstX, firstY, previousValid, valid(secondX, secondY));
+				walker(walk, pixel);
 			}
 		}
 	}
 
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineStrip
+	/// \brief	Draws points[0] -> points[1] -> ... -> points[count - 1].
+	void DrawLineStrip(const AEVec2* points, u32 count, const Color& c)
+	{
+		DrawLineChain(points, count, c, false);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineLoop
+	/// \brief	Draws the strip through points and back to points[0].
+	void DrawLineLoop(const AEVec2* points, u32 count, const Color& c)
+	{
+		DrawLineChain(points, count, c, true);
+	}
+
 	/// @TODO
 	// ------------------------------------------------------------------------
 	/// \fn	DrawRect
 	/// \brief	Wrapper function, draws a rectangle using the above line method. 
 	void DrawRect(const AEVec2& r, const AEVec2& size, const Color& c)
 	{
-		//Get each corner of the rectangle
-		AEVec2 bottomRight, bottomLeft, topLeft, topRight;
-		bottomRight = { r.x + (size.x / 2), r.y - (size.y / 2) };
-		bottomLeft = { r.x - (size.x / 2), r.y - (size.y / 2) };
-		topLeft = { r.x - (size.y / 2), r.y + (size.y / 2) };
-		topRight = { r.x + (size.x / 2), r.y + (size.y / 2) };
-
-		//Draw the horizontal and vertical lines ofthe rectangle
-		DrawHorizontalLine(bottomLeft, bottomRight, c);
-		DrawHorizontalLine(topLeft, topRight, c);
-		DrawVerticalLine(bottomLeft, topLeft, c);
-		DrawVerticalLine(bottomRight, topRight, c);
+		//Each corner of the rectangle, in order around it
+		AEVec2 corners[4];
+		corners[0] = { r.x - (size.x / 2), r.y - (size.y / 2) };	//bottom left
+		corners[1] = { r.x + (size.x / 2), r.y - (size.y / 2) };	//bottom right
+		corners[2] = { r.x + (size.x / 2), r.y + (size.y / 2) };	//top right
+		corners[3] = { r.x - (size.x / 2), r.y + (size.y / 2) };	//top left
+
+		//One loop, every corner is written once
+		DrawLineLoop(corners, 4, c);
 	}
 
 	/// -----------------------------------------------------------------------
@@ -293,4 +744,105 @@ namespace Rasterizer
 			FrameBuffer::SetPixel(Round(x), Round(y), c);
 
 	}
+
+	#pragma region COLOR INTERPOLATION
+
+	/// @LAB
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLine
+	/// \brief	Function that draws a line and interpolates the color from its
+	///			two vertices. One pixel per step along the major axis like
+	///			DrawLineDDA, the color is stepped in fixed point (see
+	///			ColorStepper).
+	void DrawLine(const AEVec2& p1, const Color& c1, const AEVec2& p2, const Color& c2)
+	{
+		//chek for simple cases
+		int dX = Round(p2.x - p1.x);
+		int dY = Round(p2.y - p1.y);
+
+		if (dX == 0)
+		{
+			DrawVerticalLine(p1, c1, p2, c2);
+			return;
+		}
+		if (dY == 0)
+		{
+			DrawHorizontalLine(p1, c1, p2, c2);
+			return;
+		}
+
+		//One pixel per step along the major axis, both ends included
+		int steps = max(abs(dX), abs(dY));
+		f32 step_x = (p2.x - p1.x) / steps;
+		f32 step_y = (p2.y - p1.y) / steps;
+
+		ColorStepper c;
+		c.Setup(c1, (c2 - c1) * (1.0f / steps));
+
+		//Positions come from the step index so the far end is exact
+		for (int i = 0; i <= steps; i++)
+		{
+			SetPixel(Round(p1.x + step_x * i), Round(p1.y + step_y * i), c);
+			c.Step();
+		}
+	}
+
+	/// @TODO
+	// ------------------------------------------------------------------------
+	/// \fn		DrawHorizontalLine
+	/// \brief	Helper function that draws a horizontal line from left to right.
+	///			and interpolates the color from its two vertices. Like the
+	///			single color version the last pixel is not drawn.
+	void DrawHorizontalLine(const AEVec2& p1, const Color& c1, const AEVec2& p2, const Color& c2)
+	{
+		int x1 = Round(p1.x);
+		int x2 = Round(p2.x);
+		int y = Round(p1.y);
+		if (x1 == x2)
+			return;
+
+		//Color change per pixel from p1 towards p2
+		int count = abs(x2 - x1);
+		Color step = (c2 - c1) * (1.0f / count);
+
+		//The span is always written left to right
+		ColorStepper c;
+		if (x1 < x2)
+		{
+			c.Setup(c1, step);
+			ShadeSpan(x1, x2, y, c);
+		}
+		else
+		{
+			c.Setup(c1 + step * f32(count - 1), -step);
+			ShadeSpan(x2 + 1, x1 + 1, y, c);
+		}
+	}
+
+	/// @TODO
+	// ------------------------------------------------------------------------
+	/// \fn		DrawVerticalLine
+	/// \brief	Helper function that draws a horizontal line from left to right.
+	///			and interpolates the color from its two vertices. Like the
+	///			single color version the last pixel is not drawn.
+	void DrawVerticalLine(const AEVec2& p1, const Color& c1, const AEVec2& p2, const Color& c2)
+	{
+		int x = Round(p1.x);
+		int y1 = Round(p1.y);
+		int y2 = Round(p2.y);
+		if (y1 == y2)
+			return;
+
+		int incr = y2 > y1 ? 1 : -1;
+		ColorStepper c;
+		c.Setup(c1, (c2 - c1) * (1.0f / abs(y2 - y1)));
+
+		for (int y = y1; y != y2; y += incr)
+		{
+			SetPixel(x, y, c);
+			c.Step();
+		}
+	}
+
+	#pragma endregion
 }
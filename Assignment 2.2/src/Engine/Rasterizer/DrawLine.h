@@ -7,7 +7,7 @@ namespace Rasterizer
 	// ------------------------------------------------------------------------
 	/// enum	EDrawLineMethod
 	///	\brief	Specifies which method should be used when drawing a line. 
-	enum EDrawLineMethod { eDL_NAIVE, eDL_DDA, eDL_BRESENHAM, eDL_Count };
+	enum EDrawLineMethod { eDL_NAIVE, eDL_DDA, eDL_BRESENHAM, eDL_RUN_SLICE, eDL_DOUBLE_STEP, eDL_WU, eDL_Count };
 
 	/// @TODO
 	// ------------------------------------------------------------------------
@@ -43,8 +43,65 @@ namespace Rasterizer
 	// ------------------------------------------------------------------------
 	/// \fn		DrawLineBresenham
 	/// \brief	Draws a line using the Bresenham algorithm presented in class.
+	///			Integer only and valid in every octant, the end points keep
+	///			their sub-pixel position (see LineWalk.h).
 	void DrawLineBresenham(const AEVec2& p1, const AEVec2& p2, const Color& c);
 
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineRunSlice
+	/// \brief	Same pixels as DrawLineBresenham, written one run at a time:
+	///			each run of pixels sharing a row (or a column for steep
+	///			lines) is filled in one go, and the run lengths come from the
+	///			error term instead of a test per pixel.
+	void DrawLineRunSlice(const AEVec2& p1, const AEVec2& p2, const Color& c);
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineDoubleStep
+	/// \brief	Same pixels as DrawLineBresenham, walked from both end points
+	///			towards the middle: every iteration decides two pixels, one
+	///			from each end, so the loop runs half as many times.
+	void DrawLineDoubleStep(const AEVec2& p1, const AEVec2& p2, const Color& c);
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineWu
+	/// \brief	Anti-aliased line (Xiaolin Wu): each step along the major
+	///			axis blends the two pixels closest to the line by their
+	///			coverage, both in one go. Fixed point end points and
+	///			coverage, blended over the frame buffer in its stored color
+	///			space.
+	void DrawLineWu(const AEVec2& p1, const AEVec2& p2, const Color& c);
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLines
+	/// \brief	Draws count lines, p0[i] -> p1[i], with the current method.
+	///			The setup runs on whole batches (end points converted to fixed
+	///			point 4 at a time) and the method and color are resolved once
+	///			per call, so it is much cheaper than count DrawLine calls for
+	///			short lines. Every method draws the pixels of the integer line
+	///			walk, except Wu which runs its own setup per line. Both end
+	///			pixels are drawn.
+	///			Note: with the naive or DDA method selected the batch still
+	///			draws Bresenham's pixels, which can differ by one pixel from
+	///			what DrawLine draws for the same line with that method.
+	void DrawLines(const AEVec2* p0, const AEVec2* p1, u32 count, const Color& c);
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineStrip
+	/// \brief	Draws the connected lines points[0] -> points[1] -> ... ->
+	///			points[count - 1] with the current method. Like DrawLines,
+	///			but every point is converted once for the two lines using it
+	///			and its pixel is written once: each line after the first
+	///			skips its first pixel (Wu lines are still drawn one by one).
+	///			Naive and DDA draw Bresenham's pixels, as in DrawLines.
+	void DrawLineStrip(const AEVec2* points, u32 count, const Color& c);
+
+	// ------------------------------------------------------------------------
+	/// \fn		DrawLineLoop
+	/// \brief	DrawLineStrip plus the line back to points[0], which skips
+	///			both of its end pixels. Two points draw a single line, the
+	///			line walk plots the same pixels in both directions.
+	void DrawLineLoop(const AEVec2* points, u32 count, const Color& c);
+
 	/// @TODO
 	// ------------------------------------------------------------------------
 	/// \fn	DrawRect
@@ -79,8 +79,10 @@ namespace Rasterizer
 		float mInvMB = (vtx[BOT]->x - vtx[MID]->x) / (vtx[BOT]->y - vtx[MID]->y);
 
 		//1.3. Initialize loop variables
-		float yS = vtx[TOP]->y;
-		float yE = vtx[MID]->y;
+		//Scan line limits, rounded once per vertex instead of per loop test
+		int rowY[3] = { Round(vtx[TOP]->y), Round(vtx[MID]->y), Round(vtx[BOT]->y) };
+		int yS = rowY[0];
+		int yE = rowY[1];
 
 		float xL = vtx[TOP]->x;
 		float xR = vtx[TOP]->x;
@@ -93,7 +95,7 @@ namespace Rasterizer
 		{
 			//2.1. Top region
 
-			for (int y = Round(yS); y >= Round(yE); y--)	//Trav on y: for every scan line
+			for (int y = yS; y >= yE; y--)	//Trav on y: for every scan line
 			{
 				for (int x = Round(xL); x <= Round(xR); x++)
 				{
@@ -108,8 +110,8 @@ namespace Rasterizer
 			//2.2. Change to bottom region
 
 			//Update loop limits to draw bottom region
-			yS = vtx[MID]->y;
-			yE = vtx[BOT]->y;
+			yS = rowY[1];
+			yE = rowY[2];
 
 			//Update xL or xR to the middle x value
 			if (midIsLeft)
@@ -145,8 +147,10 @@ namespace Rasterizer
 		float mInvMB = (vtx[BOT]->x - vtx[MID]->x) / (vtx[BOT]->y - vtx[MID]->y);
 
 		//1.3. Initialize loop variables
-		float yS = vtx[TOP]->y;
-		float yE = vtx[MID]->y;
+		//Scan line limits, rounded once per vertex instead of per loop test
+		int rowY[3] = { Ceiling(vtx[TOP]->y), Ceiling(vtx[MID]->y), Ceiling(vtx[BOT]->y) };
+		int yS = rowY[0];
+		int yE = rowY[1];
 
 		float xL = vtx[TOP]->x;
 		float xR = vtx[TOP]->x;
@@ -159,7 +163,7 @@ namespace Rasterizer
 		{
 			//2.1. Top region
 
-			for (int y = Ceiling(yS); y >= Ceiling(yE) + 1; y--)	//Trav on y: for every scan line
+			for (int y = yS; y >= yE + 1; y--)	//Trav on y: for every scan line
 			{
 				for (int x = Floor(xL); x <= Floor(xR) - 1; x++)
 				{
@@ -174,8 +178,8 @@ namespace Rasterizer
 			//2.2. Change to bottom region
 
 			//Update loop limits to draw bottom region
-			yS = vtx[MID]->y;
-			yE = vtx[BOT]->y;
+			yS = rowY[1];
+			yE = rowY[2];
 
 			//Update xL or xR to the middle x value
 			if (midIsLeft)
@@ -260,8 +264,10 @@ namespace Rasterizer
 
 		//1.3. Set the data for the loop
 		//Loop variables
-		float yS = vtx[TOP]->mPosition.y;
-		float yE = vtx[MID]->mPosition.y;
+		//Scan line limits, rounded once per vertex instead of per loop test
+		int rowY[3] = { Ceiling(vtx[TOP]->mPosition.y), Ceiling(vtx[MID]->mPosition.y), Ceiling(vtx[BOT]->mPosition.y) };
+		int yS = rowY[0];
+		int yE = rowY[1];
 		float xL = vtx[TOP]->mPosition.x;
 		float xR = vtx[TOP]->mPosition.x;
 
@@ -277,34 +283,34 @@ namespace Rasterizer
 		for (int i = 1; i <= 2; i++)
 		{
 			//2.1. Start with the data for TOP-MID
-			//Loop on y
-			for (int y = Ceiling(yS); y >= Ceiling(yE) + 1; y--)
+			//Loop on y. The edge colors are computed from the row count
+			//instead of accumulated, so they do not drift on tall triangles
+			int rows = 0;
+			for (int y = yS; y >= yE + 1; y--, rows++)
 			{
 				//Compute the color increment
-				Color step_C = (cR - cL) * (1.0f / (xR - xL));
-				Color c = cL;
-
-				//Loop on x
-				for (int x = Floor(xL); x <= Floor(xR) - 1; x++)
-				{
-					//Set pixel on the screen
-					FrameBuffer::SetPixel(x, y, c);
+				Color rowL = cL - step_L * f32(rows);
+				Color rowR = cR - step_R * f32(rows);
+				Color step_C = (rowR - rowL) * (1.0f / (xR - xL));
 
-					//Change the color
-					c += step_C;
-				}
+				//Loop on x, stepping the color in fixed point
+				ColorStepper c;
+				c.Setup(rowL, step_C);
+				ShadeSpan(Floor(xL), Floor(xR), y, c);
 
-				//Update color and position
+				//Update position
 				xL -= slopeLeft;
 				xR -= slopeRight;
-				cL -= step_L;
-				cR -= step_R;
 			}
 
+			//Edge colors at the end of the segment
+			cL -= step_L * f32(rows);
+			cR -= step_R * f32(rows);
+
 			//2.2. Change the data for MID-BOT
 			//Change the first and last values of y
-			yS = vtx[MID]->mPosition.y;
-			yE = vtx[BOT]->mPosition.y;
+			yS = rowY[1];
+			yE = rowY[2];
 
 			//Set the leftmost value of x
 			if (midIsLeft)
@@ -354,14 +360,15 @@ namespace Rasterizer
 
 		//1.3. Set the data for the loop
 		//Loop variables
-		float yS = vtx[TOP]->mPosition.y;
-		float yE = vtx[MID]->mPosition.y;
+		//Scan line limits, rounded once per vertex instead of per loop test
+		int rowY[3] = { Ceiling(vtx[TOP]->mPosition.y), Ceiling(vtx[MID]->mPosition.y), Ceiling(vtx[BOT]->mPosition.y) };
+		int yS = rowY[0];
+		int yE = rowY[1];
 		float xL = vtx[TOP]->mPosition.x;
 		float xR = vtx[TOP]->mPosition.x;
 
-		//Set colors of the pixels on each side
-		Color cL = vtx[TOP]->mColor;
-		Color cR = vtx[TOP]->mColor;
+		//Y of the left edge point xL belongs to
+		float yL = vtx[TOP]->mPosition.y;
 
 		//1.3. Plane data
 		//Normal for RED
@@ -394,46 +401,35 @@ namespace Rasterizer
 		{
 			//2.1. Start with the data for TOP-MID
 			//Loop on y
-			for (int y = Ceiling(yS); y >= Ceiling(yE) + 1; y--)
+			for (int y = yS; y >= yE + 1; y--)
 			{
-				//Compute the color increment
-				Color c = cL;
-
-				//Loop on x
-				for (int x = Floor(xL); x <= Floor(xR) - 1; x++)
-				{
-					//Set pixel on the screen
-					FrameBuffer::SetPixel(x, y, c);
+				//Color at the left edge, straight from the plane equation
+				Color cL = v0.mColor + dx * (xL - v0.mPosition.x) + dy * (yL - v0.mPosition.y);
 
-					//Change the color
-					c += dx;
-				}
+				//Loop on x, stepping the color in fixed point
+				ColorStepper c;
+				c.Setup(cL, dx);
+				ShadeSpan(Floor(xL), Floor(xR), y, c);
 
-				//Update color and position
+				//Update position
 				xL -= slopeLeft;
 				xR -= slopeRight;
-				cL.r -= dy.r + slopeLeft * dx.r;
-				cL.g -= dy.g + slopeLeft * dx.g;
-				cL.b -= dy.b + slopeLeft * dx.b;
-				cL.a -= dy.a + slopeLeft * dx.a;
+				yL -= 1.0f;
 			}
 
 			//2.2. Change the data for MID-BOT
 			//Change the first and last values of y
-			yS = vtx[MID]->mPosition.y;
-			yE = vtx[BOT]->mPosition.y;
+			yS = rowY[1];
+			yE = rowY[2];
 
 			//Set the leftmost value of x
 			if (midIsLeft)
 			{
 				xL = vtx[MID]->mPosition.x;
-				cL = vtx[MID]->mColor;
+				yL = vtx[MID]->mPosition.y;
 			}
 			else
-			{
 				xR = vtx[MID]->mPosition.x;
-				cR = vtx[MID]->mColor;
-			}
 
 			//Update the slopes and steps depending on which vertex is to the left
 			slopeLeft = midIsLeft ? mInvMB : mInvTB;
@@ -470,8 +466,10 @@ namespace Rasterizer
 
 		//1.3. Set the data for the loop
 		//Loop variables
-		float yS = vtx[TOP]->mPosition.y;
-		float yE = vtx[MID]->mPosition.y;
+		//Scan line limits, rounded once per vertex instead of per loop test
+		int rowY[3] = { Ceiling(vtx[TOP]->mPosition.y), Ceiling(vtx[MID]->mPosition.y), Ceiling(vtx[BOT]->mPosition.y) };
+		int yS = rowY[0];
+		int yE = rowY[1];
 		float xL = vtx[TOP]->mPosition.x;
 		float xR = vtx[TOP]->mPosition.x;
 
@@ -485,7 +483,7 @@ namespace Rasterizer
 		{
 			//2.1. Start with the data for TOP-MID
 			//Loop on y
-			for (int y = Ceiling(yS); y >= Ceiling(yE) + 1; y--)
+			for (int y = yS; y >= yE + 1; y--)
 			{
 				//Loop on x
 				for (int x = Floor(xL); x <= Floor(xR) - 1; x++)
@@ -523,8 +521,8 @@ namespace Rasterizer
 			
 			//2.2. Change the data for MID-BOT
 			//Change the first and last values of y
-			yS = vtx[MID]->mPosition.y;
-			yE = vtx[BOT]->mPosition.y;
+			yS = rowY[1];
+			yE = rowY[2];
 
 			//Set the leftmost value of x
 			if (midIsLeft)
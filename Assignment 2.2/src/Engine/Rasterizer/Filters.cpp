@@ -0,0 +1,399 @@
+// ----------------------------------------------------------------------------
+// File Name		:	Filters.cpp
+// Purpose			:	Blur and convolution filters over frame buffer regions.
+//						Every pixel is widened to 4 x 32 bit lanes (one per
+//						channel) so a whole pixel is processed per instruction.
+//						Rows are filtered in place; columns are filtered in
+//						narrow strips that are copied to a contiguous buffer
+//						first, so the frame buffer is only ever read row-wise.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+#include "..\Utils\AlignedPool.h"
+#include <emmintrin.h>
+#include <atomic>
+#include <thread>
+
+namespace Rasterizer
+{
+	// columns filtered together in the vertical pass
+	static const u32 cStripWidth = 8;
+
+	// most scratch buffers set up for one filter call
+	static const u32 cMaxScratchSlots = 64;
+
+	// ------------------------------------------------------------------------
+	/// \fn		ClipRegion
+	/// \brief	Clips the rectangle to the frame buffer. Returns false if
+	///			nothing is left.
+	static bool ClipRegion(u32 x, u32 y, u32& w, u32& h)
+	{
+		u32 fbWidth = FrameBuffer::GetWidth();
+		u32 fbHeight = FrameBuffer::GetHeight();
+		if (!FrameBuffer::GetBufferData() || x >= fbWidth || y >= fbHeight)
+			return false;
+
+		w = min(w, fbWidth - x);
+		h = min(h, fbHeight - y);
+		return w != 0 && h != 0;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		LoadPixels
+	/// \brief	Widens count RGBA pixels to one 4 x s32 vector per pixel.
+	static void LoadPixels(const u8* src, __m128i* dst, u32 count)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		// 4 pixels at a time
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+			__m128i lo = _mm_unpacklo_epi8(p, zero);
+			__m128i hi = _mm_unpackhi_epi8(p, zero);
+			dst[i] = _mm_unpacklo_epi16(lo, zero);
+			dst[i + 1] = _mm_unpackhi_epi16(lo, zero);
+			dst[i + 2] = _mm_unpacklo_epi16(hi, zero);
+			dst[i + 3] = _mm_unpackhi_epi16(hi, zero);
+		}
+
+		// remainder
+		for (; i < count; ++i)
+		{
+			s32 p;
+			memcpy(&p, src + i * 4, 4);
+			dst[i] = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(p), zero), zero);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		StorePixel
+	/// \brief	Saturates one 4 x s32 vector back to an RGBA pixel.
+	static void StorePixel(__m128i src, u8* dst)
+	{
+		__m128i p = _mm_packs_epi32(src, src);
+		s32 packed = _mm_cvtsi128_si32(_mm_packus_epi16(p, p));
+		memcpy(dst, &packed, 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		StorePixels
+	/// \brief	Inverse of LoadPixels, channels are saturated to [0, 255].
+	static void StorePixels(const __m128i* src, u8* dst, u32 count)
+	{
+		// 4 pixels at a time
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i lo = _mm_packs_epi32(src[i], src[i + 1]);
+			__m128i hi = _mm_packs_epi32(src[i + 2], src[i + 3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(lo, hi));
+		}
+
+		// remainder
+		for (; i < count; ++i)
+			StorePixel(src[i], dst + i * 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		BoxLine
+	/// \brief	Running sum box filter of a line of count pixels. The window is
+	///			moved one pixel per step: the pixel entering is added and the
+	///			one leaving is subtracted. Sums are exact integers, only the
+	///			average is rounded.
+	static void BoxLine(const __m128i* src, __m128i* dst, u32 count, u32 radius)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / f32(2 * radius + 1));
+		s32 last = s32(count) - 1;
+		s32 r = s32(radius);
+
+		// initial window around pixel 0, clamped to the edge
+		__m128i sum = _mm_setzero_si128();
+		for (s32 i = -r; i <= r; ++i)
+			sum = _mm_add_epi32(sum, src[max(0, min(i, last))]);
+
+		for (s32 i = 0; i <= last; ++i)
+		{
+			dst[i] = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+			sum = _mm_add_epi32(sum, src[min(i + r + 1, last)]);
+			sum = _mm_sub_epi32(sum, src[max(i - r, 0)]);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ConvolveLine
+	/// \brief	Direct convolution of a line of count pixels with 2 * radius + 1
+	///			weights, clamped to the edge.
+	static void ConvolveLine(const __m128i* src, __m128i* dst, u32 count, const f32* kernel, u32 radius)
+	{
+		s32 last = s32(count) - 1;
+		s32 r = s32(radius);
+
+		for (s32 i = 0; i <= last; ++i)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (s32 k = -r; k <= r; ++k)
+			{
+				__m128 p = _mm_cvtepi32_ps(src[max(0, min(i + k, last))]);
+				sum = _mm_add_ps(sum, _mm_mul_ps(p, _mm_set1_ps(kernel[k + r])));
+			}
+			dst[i] = _mm_cvtps_epi32(sum);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \struct	BoxOp
+	/// \brief	Line filter running one or more box passes back to back.
+	struct BoxOp
+	{
+		const u32*	mRadii;
+		u32			mCount;
+
+		// filters a into b and back; returns the buffer holding the result
+		__m128i* operator()(__m128i* a, __m128i* b, u32 count) const
+		{
+			for (u32 i = 0; i < mCount; ++i)
+			{
+				BoxLine(a, b, count, mRadii[i]);
+				__m128i* t = a; a = b; b = t;
+			}
+			return a;
+		}
+	};
+
+	// ------------------------------------------------------------------------
+	/// \struct	ConvolveOp
+	/// \brief	Line filter for SeparableConvolve.
+	struct ConvolveOp
+	{
+		const f32*	mKernel;
+		u32			mRadius;
+
+		__m128i* operator()(__m128i* a, __m128i* b, u32 count) const
+		{
+			ConvolveLine(a, b, count, mKernel, mRadius);
+			return b;
+		}
+	};
+
+	// ------------------------------------------------------------------------
+	/// \class	ScratchSlots
+	/// \brief	Pairs of line buffers for the two passes, one per thread that
+	///			ParallelFor may use. They are all allocated before filtering so
+	///			a failure leaves the region untouched instead of half filtered.
+	///			A batch takes a free slot while it runs; no more batches run at
+	///			once than there are slots, except past cMaxScratchSlots threads
+	///			where a batch waits for a slot.
+	class ScratchSlots
+	{
+	public:
+		ScratchSlots() : mCount(0), mSize(0) {}
+		~ScratchSlots()
+		{
+			for (u32 i = 0; i < mCount; ++i)
+				AlignedPoolFree(mBuffers[i]);
+		}
+
+		// room for 2 * lineSize pixels per slot
+		bool Allocate(u32 lineSize)
+		{
+			mSize = lineSize;
+			u32 count = min(ParallelGetThreadCount(), cMaxScratchSlots);
+			for (mCount = 0; mCount < count; ++mCount)
+			{
+				//Aligned storage, std::vector does not align __m128i on Win32
+				mBuffers[mCount] = static_cast<__m128i*>(AlignedPoolAlloc(2 * size_t(lineSize) * sizeof(__m128i)));
+				if (!mBuffers[mCount])
+					return false;
+				mBusy[mCount] = false;
+			}
+			return true;
+		}
+
+		u32 GetLineSize() const
+		{
+			return mSize;
+		}
+
+		u32 Acquire()
+		{
+			for (;;)
+			{
+				for (u32 i = 0; i < mCount; ++i)
+					if (!mBusy[i].exchange(true))
+						return i;
+				std::this_thread::yield();
+			}
+		}
+		__m128i* GetBuffer(u32 slot) const
+		{
+			return mBuffers[slot];
+		}
+		void Release(u32 slot)
+		{
+			mBusy[slot] = false;
+		}
+
+	private:
+		// no copies
+		ScratchSlots(const ScratchSlots&);
+		ScratchSlots& operator=(const ScratchSlots&);
+
+		u32					mCount;
+		u32					mSize;
+		__m128i*			mBuffers[cMaxScratchSlots];
+		std::atomic<bool>	mBusy[cMaxScratchSlots];
+	};
+
+	// ------------------------------------------------------------------------
+	/// \fn		FilterRows
+	/// \brief	Horizontal pass. Rows are split across threads, each batch
+	///			works on the line buffers of its scratch slot.
+	template <typename LineOp>
+	static void FilterRows(u32 x, u32 y, u32 w, u32 h, const LineOp& op, ScratchSlots& scratch)
+	{
+		Surface target = FrameBuffer::GetSurface();
+
+		u32 rowBatch = max(1u, 4096u / w);
+		ParallelFor(h, rowBatch, [=, &op, &scratch](unsigned begin, unsigned end)
+		{
+			u32 slot = scratch.Acquire();
+			__m128i* a = scratch.GetBuffer(slot);
+			__m128i* b = a + scratch.GetLineSize();
+
+			for (u32 row = begin; row < end; ++row)
+			{
+				u8* pixels = target.GetPixel(x, y + row);
+				LoadPixels(pixels, a, w);
+				StorePixels(op(a, b, w), pixels, w);
+			}
+			scratch.Release(slot);
+		});
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FilterColumns
+	/// \brief	Vertical pass. The region is cut in strips of cStripWidth
+	///			columns, split across threads. A strip is read row by row into
+	///			a column major buffer, filtered column by column and written
+	///			back row by row.
+	template <typename LineOp>
+	static void FilterColumns(u32 x, u32 y, u32 w, u32 h, const LineOp& op, ScratchSlots& scratch)
+	{
+		Surface target = FrameBuffer::GetSurface();
+
+		u32 stripCount = (w + cStripWidth - 1) / cStripWidth;
+		ParallelFor(stripCount, 1, [=, &op, &scratch](unsigned begin, unsigned end)
+		{
+			u32 slot = scratch.Acquire();
+			__m128i* a = scratch.GetBuffer(slot);
+			__m128i* b = a + scratch.GetLineSize();
+			__m128i row[cStripWidth];
+			__m128i* result[cStripWidth];
+
+			for (u32 s = begin; s < end; ++s)
+			{
+				u32 sx = x + s * cStripWidth;
+				u32 sw = min(cStripWidth, x + w - sx);
+
+				// gather
+				for (u32 j = 0; j < h; ++j)
+				{
+					LoadPixels(target.GetPixel(sx, y + j), row, sw);
+					for (u32 c = 0; c < sw; ++c)
+						a[c * h + j] = row[c];
+				}
+
+				// filter
+				for (u32 c = 0; c < sw; ++c)
+					result[c] = op(a + c * h, b + c * h, h);
+
+				// scatter
+				for (u32 j = 0; j < h; ++j)
+				{
+					for (u32 c = 0; c < sw; ++c)
+						row[c] = result[c][j];
+					StorePixels(row, target.GetPixel(sx, y + j), sw);
+				}
+			}
+			scratch.Release(slot);
+		});
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FilterRegion
+	/// \brief	Sets up the scratch buffers, then runs both passes. Returns
+	///			false, without touching the region, if they cannot be
+	///			allocated.
+	template <typename LineOp>
+	static bool FilterRegion(u32 x, u32 y, u32 w, u32 h, const LineOp& op)
+	{
+		ScratchSlots scratch;
+		if (!scratch.Allocate(max(w, cStripWidth * h)))
+			return false;
+
+		FilterRows(x, y, w, h, op, scratch);
+		FilterColumns(x, y, w, h, op, scratch);
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		BoxBlur
+	/// \brief	Averages the (2 * radius + 1)^2 pixels around every pixel.
+	bool BoxBlur(u32 x, u32 y, u32 w, u32 h, u32 radius)
+	{
+		if (radius == 0 || !ClipRegion(x, y, w, h))
+			return true;
+
+		BoxOp op = { &radius, 1 };
+		return FilterRegion(x, y, w, h, op);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		GaussianBlur
+	/// \brief	Three box blurs whose sizes are picked so the combined variance
+	///			matches sigma^2 (W. Wells, "Efficient synthesis of gaussian
+	///			filters by cascaded uniform filters").
+	bool GaussianBlur(u32 x, u32 y, u32 w, u32 h, f32 sigma)
+	{
+		if (sigma <= 0.0f || !ClipRegion(x, y, w, h))
+			return true;
+
+		// ideal box width, rounded down to the closest odd width
+		const u32 passes = 3;
+		f32 ideal = sqrtf(12.0f * sigma * sigma / passes + 1.0f);
+		s32 lower = s32(ideal);
+		if (lower % 2 == 0)
+			--lower;
+		if (lower < 1)
+			lower = 1;
+
+		// how many passes use the lower width, the rest use lower + 2
+		f32 m = (12.0f * sigma * sigma - passes * lower * lower - 4.0f * passes * lower - 3.0f * passes) / (-4.0f * lower - 4.0f);
+		s32 lowerCount = s32(floorf(m + 0.5f));
+
+		u32 radii[passes];
+		for (u32 i = 0; i < passes; ++i)
+			radii[i] = u32((s32(i) < lowerCount ? lower : lower + 2) / 2);
+
+		BoxOp op = { radii, passes };
+		return FilterRegion(x, y, w, h, op);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SeparableConvolve
+	/// \brief	Convolves with the kernel k * k^T, k has 2 * radius + 1 weights.
+	bool SeparableConvolve(u32 x, u32 y, u32 w, u32 h, const f32* kernel, u32 radius)
+	{
+		if (!kernel)
+			return false;
+		if (!ClipRegion(x, y, w, h))
+			return true;
+
+		ConvolveOp op = { kernel, radius };
+		return FilterRegion(x, y, w, h, op);
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef CS200_FILTERS_H_
+#define CS200_FILTERS_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \brief	Neighborhood filters over a rectangle [x, x+w) x [y, y+h) of the
+	///			frame buffer, clipped to its bounds. The rectangle is filtered
+	///			as an image of its own: samples outside of it are clamped to
+	///			its edge. All the filters are separable, a horizontal pass over
+	///			the rows is followed by a vertical pass over the columns. All
+	///			four channels (alpha too) are filtered. They return false if
+	///			their scratch memory cannot be allocated, the region is then
+	///			left as it was.
+
+	/// -----------------------------------------------------------------------
+	/// \fn		BoxBlur
+	/// \brief	Averages the (2 * radius + 1)^2 pixels around every pixel. Uses
+	///			running sums so the cost does not depend on the radius.
+	bool BoxBlur(u32 x, u32 y, u32 w, u32 h, u32 radius);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		GaussianBlur
+	/// \brief	Approximates a gaussian blur of standard deviation sigma with
+	///			three box blurs. Cost does not depend on sigma either.
+	bool GaussianBlur(u32 x, u32 y, u32 w, u32 h, f32 sigma);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SeparableConvolve
+	/// \brief	Convolves with the kernel k * k^T where k has 2 * radius + 1
+	///			weights (k[radius] is the center). The weights are used as
+	///			they are, they should add up to 1 to keep the brightness.
+	///			Returns false for a NULL kernel.
+	bool SeparableConvolve(u32 x, u32 y, u32 w, u32 h, const f32* kernel, u32 radius);
+}
+
+#endif
@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+// File Name		:	FixedColor.cpp
+// Purpose			:	Fixed point (16.16) color stepping used by the color
+//						interpolating lines and triangles.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+
+namespace Rasterizer
+{
+	// inputs are clamped to this range so the 16.16 values cannot overflow
+	static const f32 cMaxMagnitude = 4.0f;
+
+	// ------------------------------------------------------------------------
+	/// \fn		ToFixed
+	/// \brief	Scales every channel and converts to 16.16 (rounded).
+	static __m128i ToFixed(const Color& c, __m128 scale)
+	{
+		const __m128 limit = _mm_set1_ps(cMaxMagnitude);
+		__m128 v = _mm_min_ps(_mm_max_ps(c.Get(), _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+		return _mm_cvtps_epi32(_mm_mul_ps(_mm_mul_ps(v, scale), _mm_set1_ps(65536.0f)));
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Setup
+	/// \brief	Picks the output range from the current color space and
+	///			converts the start value and the step.
+	void ColorStepper::Setup(const Color& start, const Color& step)
+	{
+		__m128 scale;
+		if (GetColorSpace() == eCS_SRGB)
+		{
+			f32 last = f32(cSRGBEncodeEntries - 1);
+			scale = _mm_setr_ps(last, last, last, 255.0f);
+			mLimit = _mm_setr_epi16(s16(last), s16(last), s16(last), 255, 0, 0, 0, 0);
+			mEncode = GetSRGBEncodeTable();
+		}
+		else
+		{
+			scale = _mm_set1_ps(255.0f);
+			mLimit = _mm_setzero_si128();
+			mEncode = NULL;
+		}
+
+		mValue = ToFixed(start, scale);
+		mStep = ToFixed(step, scale);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Skip
+	/// \brief	Same as calling Step steps times (SSE2 has no 32 bit multiply,
+	///			the lanes are done one by one). The product is taken in 64
+	///			bits and saturated, a long skip with a steep gradient would
+	///			overflow 16.16 otherwise.
+	void ColorStepper::Skip(s32 steps)
+	{
+		s32 value[4], step[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(value), mValue);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(step), mStep);
+		for (u32 i = 0; i < 4; ++i)
+		{
+			s64 v = s64(value[i]) + s64(step[i]) * steps;
+			value[i] = s32(max(min(v, s64(0x7FFFFFFF)), -s64(0x80000000)));
+		}
+		mValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value));
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetPixel
+	/// \brief	Writes the current value of the stepper at (x, y).
+	void SetPixel(s32 x, s32 y, const ColorStepper& c)
+	{
+		u32 p = c.Pack();
+		FrameBuffer::SetPixel(u32(x), u32(y), u8(p), u8(p >> 8), u8(p >> 16), u8(p >> 24));
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ShadeSpan
+	/// \brief	Clips [x0, x1) x y to the bound view, skips the stepper past
+	///			the clipped pixels and writes the rest.
+	void ShadeSpan(s32 x0, s32 x1, s32 y, const ColorStepper& stepper)
+	{
+		//Local copy, Skip and Step advance the stepper
+		ColorStepper c = stepper;
+		Surface view = FrameBuffer::GetSurface();
+		s32 vy = y - s32(FrameBuffer::GetOriginY());
+		if (!view.mPixels || vy < 0 || vy >= s32(view.mHeight))
+			return;
+
+		s32 begin = x0 - s32(FrameBuffer::GetOriginX());
+		s32 end = min(x1 - s32(FrameBuffer::GetOriginX()), s32(view.mWidth));
+		if (begin < 0)
+		{
+			c.Skip(-begin);
+			begin = 0;
+		}
+		if (begin >= end)
+			return;
+
+		u8* row = view.GetPixel(u32(begin), u32(vy));
+		for (s32 x = begin; x < end; ++x, row += 4)
+		{
+			u32 p = c.Pack();
+			memcpy(row, &p, 4);
+			c.Step();
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillSpan
+	/// \brief	Clips [x0, x1) x y to the bound view and fills it with pixel.
+	void FillSpan(s32 x0, s32 x1, s32 y, u32 pixel)
+	{
+		Surface view = FrameBuffer::GetSurface();
+		s32 vy = y - s32(FrameBuffer::GetOriginY());
+		if (!view.mPixels || vy < 0 || vy >= s32(view.mHeight))
+			return;
+
+		s32 begin = max(x0 - s32(FrameBuffer::GetOriginX()), 0);
+		s32 end = min(x1 - s32(FrameBuffer::GetOriginX()), s32(view.mWidth));
+		if (begin >= end)
+			return;
+
+		u8* row = view.GetPixel(u32(begin), u32(vy));
+		s32 count = end - begin;
+		__m128i v = _mm_set1_epi32(s32(pixel));
+		for (; count >= 4; count -= 4, row += 16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row), v);
+		for (; count > 0; --count, row += 4)
+			memcpy(row, &pixel, 4);
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef CS200_FIXED_COLOR_H_
+#define CS200_FIXED_COLOR_H_
+
+#include <emmintrin.h>	// SSE2
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \struct	ColorStepper
+	/// \brief	Fixed point color interpolator for the gradient rasterizers.
+	///			The four channels are 16.16 integers in one SSE register,
+	///			already scaled to the output range (255, or the sRGB table
+	///			size in eCS_SRGB mode), so a step is one integer add and
+	///			producing a pixel is a shift and two saturating packs: no
+	///			float adds, no float to u8 conversions and no drift.
+	struct ColorStepper
+	{
+		// start value and per step increment, as colors
+		void	Setup(const Color& start, const Color& step);
+
+		void	Step() { mValue = _mm_add_epi32(mValue, mStep); }
+		void	Skip(s32 steps);
+
+		// current value as an RGBA pixel (bytes in memory order)
+		u32		Pack() const
+		{
+			__m128i v = _mm_packs_epi32(_mm_srai_epi32(mValue, 16), _mm_setzero_si128());
+			if (!mEncode)
+			{
+				v = _mm_packus_epi16(v, v);
+				return u32(_mm_cvtsi128_si32(v));
+			}
+
+			// sRGB: rgb are table indices, alpha is a byte
+			v = _mm_min_epi16(_mm_max_epi16(v, _mm_setzero_si128()), mLimit);
+			return u32(mEncode[_mm_extract_epi16(v, 0)]) |
+				(u32(mEncode[_mm_extract_epi16(v, 1)]) << 8) |
+				(u32(mEncode[_mm_extract_epi16(v, 2)]) << 16) |
+				(u32(_mm_extract_epi16(v, 3)) << 24);
+		}
+
+		__m128i		mValue;
+		__m128i		mStep;
+		__m128i		mLimit;		// largest index/byte per channel (sRGB only)
+		const u8 *	mEncode;	// sRGB table, NULL in gamma space
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetPixel
+	/// \brief	Writes the current value of the stepper at (x, y), through
+	///			FrameBuffer::SetPixel (view origin and clipping included).
+	void SetPixel(s32 x, s32 y, const ColorStepper& c);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ShadeSpan
+	/// \brief	Writes the pixels [x0, x1) of row y, the stepper holds the
+	///			color of x0 and is stepped once per pixel. The span is clipped
+	///			to the bound view once, the inner loop only adds and stores.
+	void ShadeSpan(s32 x0, s32 x1, s32 y, const ColorStepper& c);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillSpan
+	/// \brief	Solid version of ShadeSpan: writes pixel (RGBA bytes in memory
+	///			order) to [x0, x1) of row y, clipped to the bound view, 4
+	///			pixels per store.
+	void FillSpan(s32 x0, s32 x1, s32 y, u32 pixel);
+}
+
+#endif
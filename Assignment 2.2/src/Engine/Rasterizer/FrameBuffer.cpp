@@ -1,12 +1,24 @@
 #include <AEEngine.h> // f32, u32, etc...
 #include "FrameBuffer.h"
 #include "Color.h"
+#include "Surface.h"
+#include "ColorSpace.h"
+#include "PixelFormat.h"
+#include "PatternFill.h"
+#include "PixelShader.h"
+#include "FrameHash.h"
+#include "..\Utils\AlignedPool.h"
 
 // file io
 #include <fstream>
 #include <sstream>
+#include <string>
 
-#define COLOR_COMP 4
+// storage format of the frame buffer (the span writers and Surface assume
+// 4 bytes per pixel in R G B A order)
+typedef Rasterizer::FormatRGBA8 FrameFormat;
+#define COLOR_COMP u32(sizeof(FrameFormat::Pixel))
+static_assert(sizeof(FrameFormat::Pixel) == 4, "the span writers stride 4 bytes per pixel");
 
 namespace Rasterizer
 {
@@ -15,62 +27,193 @@ namespace Rasterizer
 	u8 *	FrameBuffer::frameBuffer = NULL;
 	u32		FrameBuffer::frameBufferWidth = 0;
 	u32		FrameBuffer::frameBufferHeight = 0;
+	u32		FrameBuffer::frameBufferPitch = 0;
+	u32		FrameBuffer::frameBufferOriginX = 0;
+	u32		FrameBuffer::frameBufferOriginY = 0;
+	u8 *	FrameBuffer::rootBuffer = NULL;
+	u32		FrameBuffer::rootWidth = 0;
+	u32		FrameBuffer::rootHeight = 0;
+	u32		FrameBuffer::rootPitch = 0;
+
+	// rows start on a cache line
+	static const u32 cRowAlignment = 64;
+
+	// pitches that are a multiple of this map rows to the same cache sets
+	static const u32 cAliasingStride = 1024;
+
+	// tightly packed copy of the frame buffer for the engine calls that do
+	// not take a pitch (texture upload, png save)
+	static std::vector<u8> sPackedPixels;
+
+	// Present keeps the last texture (and its quad) alive and only uploads
+	// a new one when a tile hash changed
+	static AEGfxTexture *	sPresentTexture = NULL;
+	static AEGfxTriList *	sPresentQuad = NULL;
+	static TileHashes		sPresentHashes;
+
+	// last file written by SaveToFile and SaveToImageFile, with the hash of
+	// the frame it holds and the size the file had once written
+	struct SavedFrame
+	{
+		std::string	mFilename;
+		u64			mHash;
+		s64			mFileSize;
+	};
+	static SavedFrame sSavedBinary;
+	static SavedFrame sSavedImage;
+
+	// ---------------------------------------------------------------------------
+	// \fn		ComputePitch
+	// \brief	Rounds the row size up to a cache line. When the result is a
+	//			multiple of cAliasingStride (e.g. widths of 256, 512, 1024...)
+	//			one cache line of padding is added so that consecutive rows do
+	//			not all compete for the same cache sets.
+	static u32 ComputePitch(u32 width)
+	{
+		u32 pitch = (width * COLOR_COMP + cRowAlignment - 1) & ~(cRowAlignment - 1);
+		if (pitch % cAliasingStride == 0)
+			pitch += cRowAlignment;
+		return pitch;
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		GetPackedPixels
+	// \brief	Returns the pixels of a surface without row padding, copying
+	//			them to sPackedPixels only if the surface is padded.
+	static const u8* GetPackedPixels(const Surface& s)
+	{
+		u32 rowBytes = s.mWidth * COLOR_COMP;
+		if (s.mPitch == rowBytes)
+			return s.mPixels;
+
+		sPackedPixels.resize(rowBytes * s.mHeight);
+		for (u32 y = 0; y < s.mHeight; ++y)
+			memcpy(&sPackedPixels[y * rowBytes], s.GetRow(y), rowBytes);
+		return sPackedPixels.data();
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		ReleasePresentTexture
+	// \brief	Unloads the texture kept by Present, the next Present uploads
+	//			the frame again.
+	static void ReleasePresentTexture()
+	{
+		if (sPresentTexture)
+			AEGfxTextureUnload(sPresentTexture);
+		sPresentTexture = NULL;
+		sPresentHashes.Reset();
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		GetFileSize
+	// \brief	Size in bytes of filename, -1 if it cannot be opened.
+	static s64 GetFileSize(const char* filename)
+	{
+		std::ifstream fp(filename, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!fp.good())
+			return -1;
+		return s64(fp.tellg());
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		IsAlreadySaved
+	// \brief	Whether filename was the last file written with this frame and
+	//			still exists with the size it was written with, so a file
+	//			truncated or replaced by something else is written again.
+	static bool IsAlreadySaved(const SavedFrame& saved, const char* filename, u64 hash)
+	{
+		return saved.mHash == hash && saved.mFilename == filename &&
+			saved.mFileSize >= 0 && GetFileSize(filename) == saved.mFileSize;
+	}
 
 	// ---------------------------------------------------------------------------
 	// \fn		Allocate
 	// \brief	Allocate memory for the frame buffer given by the width and height. 
-	bool FrameBuffer::Allocate(u32 width, u32 height)
+	//			The memory is 64 byte aligned and comes from the aligned pool.
+	//			The current block is kept when the new size fits in it, so
+	//			switching resolutions back and forth does not reallocate.
+	//			Asking for the current size again keeps the contents.
+	bool FrameBuffer::Allocate(u32 width, u32 height, u32 pitch)
 	{
-		// free any data
-		Delete();
+		if (pitch < width * COLOR_COMP)
+			pitch = ComputePitch(width);
 
-		frameBufferWidth = width;
-		frameBufferHeight = height;
-		frameBuffer = new u8[width * height * COLOR_COMP];
-		if (frameBuffer)
+		// same size: nothing to do
+		if (rootBuffer && width == rootWidth && height == rootHeight && pitch == rootPitch)
 		{
-			Clear(0, 0, 0);
+			ResetViewport();
 			return true;
 		}
-		return false;
+
+		// get a bigger block if needed
+		size_t bytes = size_t(pitch) * height;
+		if (bytes > AlignedPoolGetCapacity(rootBuffer))
+		{
+			Delete();
+			rootBuffer = static_cast<u8*>(AlignedPoolAlloc(bytes));
+			if (!rootBuffer)
+				return false;
+		}
+
+		rootWidth = width;
+		rootHeight = height;
+		rootPitch = pitch;
+		ResetViewport();
+		Clear(0, 0, 0);
+		return true;
 	}
 	// ---------------------------------------------------------------------------
 	// \fn		Delete
 	// \brief	Free the memory allocated in the function above. 
 	void FrameBuffer::Delete()
 	{
-		// delete the data
-
-		if (frameBuffer)
-			delete[] frameBuffer;
+		// give the block back to the pool
+		AlignedPoolFree(rootBuffer);
+		ReleasePresentTexture();
+		if (sPresentQuad)
+			AEGfxTriFree(sPresentQuad);
+		sPresentQuad = NULL;
+
+		rootBuffer = NULL;
+		rootWidth = 0;
+		rootHeight = 0;
+		rootPitch = 0;
+		ResetViewport();
 	}
 
 	// ---------------------------------------------------------------------------
 	// \fn		Present
 	// \brief	Draws the contents of the frame buffer to the screen using Alpha
-	//			Engine.
+	//			Engine. The texture is only uploaded again when the content
+	//			hash of a tile changed, static frames reuse the last one.
 	void FrameBuffer::Present()
 	{
-		if (frameBuffer && frameBufferWidth != 0 && frameBufferHeight != 0) {
-			auto tex = AEGfxTextureLoad(frameBufferWidth, frameBufferHeight, frameBuffer);
-			AEGfxTriStart();
-			AEGfxTriAdd(
-				-0.5f, 0.5f, AE_COLORS_WHITE, 0, 1,
-				-0.5f, -0.5f, AE_COLORS_WHITE, 0, 0,
-				0.5f, -0.5f, AE_COLORS_WHITE, 1, 0);
-			AEGfxTriAdd(
-				-0.5f, 0.5f, AE_COLORS_WHITE, 0, 1,
-				0.5f, -0.5f, AE_COLORS_WHITE, 1, 0,
-				0.5f, 0.5f, AE_COLORS_WHITE, 1, 1);
-			auto quad = AEGfxTriEnd();
-
-			AEGfxTextureSet(tex);
+		if (rootBuffer && rootWidth != 0 && rootHeight != 0) {
+			// the engine only uploads whole textures: any changed tile means
+			// a new one
+			if (sPresentHashes.Update(GetRootSurface()) != 0 || !sPresentTexture) {
+				if (sPresentTexture)
+					AEGfxTextureUnload(sPresentTexture);
+				sPresentTexture = AEGfxTextureLoad(rootWidth, rootHeight, const_cast<u8*>(GetPackedPixels(GetRootSurface())));
+			}
+
+			if (!sPresentQuad) {
+				AEGfxTriStart();
+				AEGfxTriAdd(
+					-0.5f, 0.5f, AE_COLORS_WHITE, 0, 1,
+					-0.5f, -0.5f, AE_COLORS_WHITE, 0, 0,
+					0.5f, -0.5f, AE_COLORS_WHITE, 1, 0);
+				AEGfxTriAdd(
+					-0.5f, 0.5f, AE_COLORS_WHITE, 0, 1,
+					0.5f, -0.5f, AE_COLORS_WHITE, 1, 0,
+					0.5f, 0.5f, AE_COLORS_WHITE, 1, 1);
+				sPresentQuad = AEGfxTriEnd();
+			}
+
+			AEGfxTextureSet(sPresentTexture);
 			AEMtx33 mtx = AEMtx33::Scale((f32)gAESysWinWidth, (f32)gAESysWinHeight);
 			AEGfxSetTransform(&mtx);
-			AEGfxTriDraw(quad);
-
-			AEGfxTextureUnload(tex);
-			AEGfxTriFree(quad);
+			AEGfxTriDraw(sPresentQuad);
 		}
 	}
 
@@ -98,15 +241,83 @@ namespace Rasterizer
 		return frameBufferHeight;
 	}
 
+	// ---------------------------------------------------------------------------
+	// \fn		GetPitch
+	// \brief	Returns the number of bytes between two rows.
+	u32		FrameBuffer::GetPitch()
+	{
+		return frameBufferPitch;
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		GetSurface
+	// \brief	Returns the bound view for Blit, Rotate, etc.
+	Surface	FrameBuffer::GetSurface()
+	{
+		return Surface(frameBuffer, frameBufferWidth, frameBufferHeight, frameBufferPitch);
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		GetRootSurface
+	// \brief	Returns the whole allocation, whatever view is bound.
+	Surface	FrameBuffer::GetRootSurface()
+	{
+		return Surface(rootBuffer, rootWidth, rootHeight, rootPitch);
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		Bind
+	// \brief	Makes every frame buffer operation work on the given surface
+	//			until the next Bind/SetViewport/ResetViewport.
+	void	FrameBuffer::Bind(const Surface& view, u32 originX, u32 originY)
+	{
+		frameBuffer = view.mPixels;
+		frameBufferWidth = view.mWidth;
+		frameBufferHeight = view.mHeight;
+		frameBufferPitch = view.mPitch;
+		frameBufferOriginX = originX;
+		frameBufferOriginY = originY;
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		GetOriginX/Y
+	// \brief	Coordinates that SetPixel/GetPixel map to the top left pixel of
+	//			the bound view.
+	u32		FrameBuffer::GetOriginX()
+	{
+		return frameBufferOriginX;
+	}
+	u32		FrameBuffer::GetOriginY()
+	{
+		return frameBufferOriginY;
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		SetViewport
+	// \brief	Binds a rectangle of the whole allocation (clipped to it).
+	//			Pixel (0, 0) becomes (x, y) of the allocation.
+	void	FrameBuffer::SetViewport(u32 x, u32 y, u32 width, u32 height)
+	{
+		Bind(GetRootSurface().SubView(x, y, width, height));
+	}
+
+	// ---------------------------------------------------------------------------
+	// \fn		ResetViewport
+	// \brief	Binds the whole allocation again.
+	void	FrameBuffer::ResetViewport()
+	{
+		Bind(GetRootSurface());
+	}
+
 	// ---------------------------------------------------------------------------
 	// \fn		Clear
-	// \brief	Sets the entire frame buffer to the provided color.
+	// \brief	Sets the entire frame buffer to the provided color, converted
+	//			in the current color space.
 	void FrameBuffer::Clear(const Color & c)
 	{
-		Clear(u8(c.r * 255.0f),
-			u8(c.g * 255.0f),
-			u8(c.b * 255.0f),
-			u8(c.a * 255.0f));
+		u8 rgba[4];
+		EncodeColors(&c, 1, rgba);
+		Clear(rgba[0], rgba[1], rgba[2], rgba[3]);
 	}
 
 	// ---------------------------------------------------------------------------
@@ -115,16 +326,7 @@ namespace Rasterizer
 	void FrameBuffer::Clear(u8 r, u8 g, u8 b, u8 a)
 	{
 		if (frameBuffer)
-		{
-			u32 totalSize = frameBufferWidth * frameBufferHeight * COLOR_COMP;
-			for (u32 i = 0; i < totalSize; i += COLOR_COMP)
-			{
-				frameBuffer[i] = r;
-				frameBuffer[i + 1] = g;
-				frameBuffer[i + 2] = b;
-				frameBuffer[i + 3] = a;
-			}
-		}
+			FillSolid(r, g, b, a);
 	}
 
 	// ---------------------------------------------------------------------------
@@ -132,30 +334,32 @@ namespace Rasterizer
 	// \brief	Sets the pixel at position x, y to the provided color. 
 	void FrameBuffer::SetPixel(u32 x, u32 y, u8 r, u8 g, u8 b, u8 a)
 	{
+		// to view coordinates (values left of/above the origin wrap around and
+		// are rejected with the rest)
+		x -= frameBufferOriginX;
+		y -= frameBufferOriginY;
+
 		// Sanity check
 		if (NULL == frameBuffer || x >= frameBufferWidth || y >= frameBufferHeight)
 			return;
 
 		// advance to pixel
-		u32 startOffset = COLOR_COMP * (y * frameBufferWidth + x);
+		size_t startOffset = size_t(y) * frameBufferPitch + x * COLOR_COMP;
 
 		// set
-		frameBuffer[startOffset] = r;
-		frameBuffer[startOffset + 1] = g;
-		frameBuffer[startOffset + 2] = b;
-		frameBuffer[startOffset + 3] = a;
+		FrameFormat::Pixel p = FrameFormat::Pack(r, g, b, a);
+		memcpy(frameBuffer + startOffset, &p, sizeof(p));
 	}
 
 	// ---------------------------------------------------------------------------
 	// \fn		SetPixel
-	// \brief	Sets the pixel at position x, y to the provided color. 
+	// \brief	Sets the pixel at position x, y to the provided color, converted
+	//			in the current color space (see ColorSpace.h).
 	void FrameBuffer::SetPixel(u32 x, u32 y, const Color& c)
 	{
-		SetPixel(x, y,
-			u8(c.r * 255.0f),
-			u8(c.g * 255.0f),
-			u8(c.b * 255.0f),
-			u8(c.a * 255.0f));
+		u8 rgba[4];
+		EncodeColors(&c, 1, rgba);
+		SetPixel(x, y, rgba[0], rgba[1], rgba[2], rgba[3]);
 	}
 
 	// ---------------------------------------------------------------------------
@@ -163,46 +367,63 @@ namespace Rasterizer
 	// \brief	Returns the color of the pixel at position x, y.
 	Color FrameBuffer::GetPixel(u32 x, u32 y)
 	{
+		// to view coordinates (values left of/above the origin wrap around and
+		// are rejected with the rest)
+		x -= frameBufferOriginX;
+		y -= frameBufferOriginY;
+
 		// Sanity check
 		if (NULL == frameBuffer || x >= frameBufferWidth || y >= frameBufferHeight)
 			return Color();
 
 		// advance to pixel
-		u32 startOffset = COLOR_COMP * (y * frameBufferWidth + x);
-
-		// Get the color component
-		u8 r = frameBuffer[startOffset];
-		u8 g = frameBuffer[startOffset + 1];
-		u8 b = frameBuffer[startOffset + 2];
-		u8 a = frameBuffer[startOffset + 3];
+		size_t startOffset = size_t(y) * frameBufferPitch + x * COLOR_COMP;
 
-		// Convert to color class
-		return Color((f32)r*255.0f, (f32)g*255.0f, (f32)b*255.0f, (f32)a*255.0f);
+		// Convert to color class, in the current color space
+		Color c;
+		DecodePixels(frameBuffer + startOffset, 1, &c);
+		return c;
 	}
 
 	// ---------------------------------------------------------------------------
 	// \fn		SaveToFile
-	// \brief	Saves the frame buffer to a binary file. 
+	// \brief	Saves the frame buffer to a binary file. Saving the same frame
+	//			to the same file again does nothing.
 	void FrameBuffer::SaveToFile(const char *filename)
 	{
 		// Sanity Check
 		if (!filename)
 			return;
 
+		// nothing changed since the last save
+		u64 hash = HashSurface(GetRootSurface());
+		if (IsAlreadySaved(sSavedBinary, filename, hash))
+			return;
+
 		// try to open the file
 		std::fstream fp(filename, std::ios::out | std::ios::binary);
 
 		if (fp.is_open() && fp.good())
 		{
 			// write header information - just width and height
-			fp.write(reinterpret_cast<const char*>(&frameBufferWidth), sizeof(u32));
-			fp.write(reinterpret_cast<const char*>(&frameBufferHeight), sizeof(u32));
+			fp.write(reinterpret_cast<const char*>(&rootWidth), sizeof(u32));
+			fp.write(reinterpret_cast<const char*>(&rootHeight), sizeof(u32));
 
-			// write pixel data
-			fp.write(reinterpret_cast<const char*>(frameBuffer), frameBufferWidth * frameBufferHeight * COLOR_COMP);
+			// write pixel data, without the row padding
+			for (u32 y = 0; y < rootHeight; ++y)
+				fp.write(reinterpret_cast<const char*>(rootBuffer + y * rootPitch), rootWidth * COLOR_COMP);
 
 			// close the file
 			fp.close();
+
+			// only remember a complete file, a failed write is tried again
+			s64 size = GetFileSize(filename);
+			if (size == s64(2 * sizeof(u32)) + s64(rootWidth) * rootHeight * COLOR_COMP)
+			{
+				sSavedBinary.mFilename = filename;
+				sSavedBinary.mHash = hash;
+				sSavedBinary.mFileSize = size;
+			}
 		}
 	}
 
@@ -224,24 +445,13 @@ namespace Rasterizer
 			fp.read(reinterpret_cast<char *>(&fbWidth), sizeof(u32));
 			fp.read(reinterpret_cast<char *>(&fbHeight), sizeof(u32));
 
-			// re-allocate the data if necessary
-			if (NULL != frameBuffer && (fbWidth * fbHeight) != (frameBufferWidth * frameBufferHeight))
-			{
-				delete[] frameBuffer;
-				frameBuffer = new u8[fbWidth * fbHeight * COLOR_COMP];
-			}
-			// no frame buffer, allocate one
-			else if (NULL == frameBuffer)
-			{
-				frameBuffer = new u8[fbWidth * fbHeight * COLOR_COMP];
-			}
+			// resize if necessary (reuses the block when it fits)
+			if (!Allocate(fbWidth, fbHeight))
+				return;
 
-			// store new width and new height
-			frameBufferWidth = fbWidth;
-			frameBufferHeight = fbHeight;
-
-			// now read the framebuffer data
-			fp.read(reinterpret_cast<char *>(frameBuffer), frameBufferWidth * frameBufferHeight * COLOR_COMP);
+			// now read the framebuffer data, one row at a time
+			for (u32 y = 0; y < rootHeight; ++y)
+				fp.read(reinterpret_cast<char *>(rootBuffer + y * rootPitch), rootWidth * COLOR_COMP);
 
 			// close the file
 			fp.close();
@@ -250,31 +460,32 @@ namespace Rasterizer
 
 	// ---------------------------------------------------------------------------
 	// \fn		SaveToImageFile
-	// \brief	Save the frame buffer to image file. 
+	// \brief	Save the frame buffer to image file. The png is not encoded
+	//			again if the same frame was the last one saved to that file.
 	void FrameBuffer::SaveToImageFile(const char * filename)
 	{
-		AEGfxSaveImagePNG(filename, frameBuffer, frameBufferWidth, frameBufferHeight);
+		if (!rootBuffer || !filename)
+			return;
+
+		u64 hash = HashSurface(GetRootSurface());
+		if (IsAlreadySaved(sSavedImage, filename, hash))
+			return;
+
+		if (AEGfxSaveImagePNG(filename, GetPackedPixels(GetRootSurface()), rootWidth, rootHeight)) {
+			sSavedImage.mFilename = filename;
+			sSavedImage.mHash = hash;
+			sSavedImage.mFileSize = GetFileSize(filename);
+		}
 	}
 
 	// Extra Challenges
+	// ---------------------------------------------------------------------------
+	// \fn		ClearCheckerboard
+	// \brief	Clears the frame buffer to a checkerboard of size x size cells.
+	//			Colors are ARGB. See PatternFill.cpp.
 	void FrameBuffer::ClearCheckerboard(u32 colors[2], u32 size)
 	{
-		u32 c = 0;
-		u32 s = 0;
-		for (u32 i = 0; i < frameBufferHeight; ++i) {
-			if (i % size == 0)
-				s = ++s % 2;
-			c = s;
-			for (u32 j = 0; j < frameBufferWidth; ++j)
-			{
-				if (j % size == 0)
-					c = ++c % 2;
-				u32 p[4];
-				AEGfxColorComp(colors[c], p, p + 1, p + 2, p + 3);
-				for (u32 k = 0; k < 4; ++k)
-					frameBuffer[(i * frameBufferWidth + j) * 4 + k] = (u8)p[k];
-			}
-		}
+		FillCheckerboard(colors, size);
 	}
 
 	void FrameBuffer::LoadFromImageFile(const char* filename) {
@@ -291,15 +502,7 @@ namespace Rasterizer
 			auto sY =  minH == frameBufferHeight ? 0 : (frameBufferHeight - imgHeight) / 2;
 
 			// copy data
-			for (u32 i = 0; i < minH; ++i) {
-				for (u32 j = 0; j < minW; ++j) {
-					for (u32 k = 0; k < 4; ++k) {
-						u32 fbIdx= ((sY+i) * frameBufferWidth + (sX+j)) * 4 + k;
-						u32 imgIdx = (i * imgWidth + j) * 4 + k;
-						frameBuffer[fbIdx] = imgPixels[imgIdx];
-					}
-				}
-			}
+			Blit(GetSurface(), sX, sY, Surface(imgPixels, imgWidth, imgHeight), 0, 0, minW, minH);
 
 			// cleanup
 			delete[] imgPixels;
@@ -328,18 +531,20 @@ namespace Rasterizer
 		the rectangle. The simplest thing is to take the average of a group of pixels in the image
 		and use it as the color of 1 pixel in the cell. 
 	*/
-	void FrameBuffer::CheckerboardImage(const char* filename, u32 size, FrameBuffer::pixelShader shader)
+	void FrameBuffer::CheckerboardImage(const char* filename, u32 size, FrameBuffer::spanShader shader)
 	{
+		if (size == 0)
+			return;
+
 		// load the file using the alpha engine
 		u8* imgPixels = 0;
 		u32 imgWidth = 0, imgHeight = 0;
 		if (AEGfxLoadImagePNG(filename, imgPixels, imgWidth, imgHeight))
 		{
-			
-			u8* cellData1 = new u8[size * size * 4];
-			u8* cellData2 = new u8[size * size * 4];
-			u8* cellSrc[2] = { cellData1, cellData2 };
-			
+			// cell 1 is the image, cell 2 the image through the shader
+			std::vector<u8> cellData1(size * size * 4, 0);
+			std::vector<u8> cellData2(size * size * 4, 0);
+
 			// we are going to 
 			auto minW = min(imgWidth, size);
 			auto minH = min(imgHeight, size);
@@ -348,86 +553,46 @@ namespace Rasterizer
 			auto sX = minW == size ? 0 : (size - imgWidth) / 2;
 			auto sY = minH == size ? 0 : (size - imgHeight) / 2;
 
-			// copy data into cell size
+			// copy data into cell size, one image row at a time
 			for (u32 i = 0; i < minH; ++i) {
-				for (u32 j = 0; j < minW; ++j) {
-					u32 sqIdx = ((sY + i) * size + (sX + j)) * 4;
-					u32 imgIdx = (i * imgWidth + j) * 4;
-
-
-					// square 1 and 2: copy original color
-					for (u32 k = 0; k < 4; ++k) {
-						cellData1[sqIdx + k] = imgPixels[imgIdx + k];
-						cellData2[sqIdx + k] = imgPixels[imgIdx + k];
-					}
-
-					// square 2: call shader execpt alpha
-					u8* pix = cellData2 + sqIdx;
-					shader(imgIdx, pix, pix + 1, pix + 2, pix + 3);
-
-				}
-			}
-
-			u32 c = 0;
-			u32 s = 0;
-			u32 sqRowSize = size * 4;
-			u32 sqRowSize2 = size;
-			for (u32 i = 0; i < frameBufferHeight; ++i) {
-				c = s;
-				u32 sqIdx = (i%size) * size * 4;
-				u32 sqIdx2 = (i * size);
-				for (u32 j = 0; j < frameBufferWidth; j+=size)
-				{
-
-					u32 fbIdx2 = (i * frameBufferWidth + j);
-					u32 fbRowSize2 = (frameBufferWidth - j);
-
-					u32 fbIdx = (i * frameBufferWidth + j) * 4;
-					u32 fbRowSize = (frameBufferWidth -j) * 4;
-					u32 minSize = min(fbRowSize, sqRowSize);
-
-					// copy square data
-					//memcpy_s(frameBuffer + fbIdx, fbRowSize, cellSrc[c] + sqIdx, minSize);
-					for (u32 k = 0; k < minSize; ++k) {
-						frameBuffer[fbIdx + k] = cellSrc[c][sqIdx + k];
-					}
-					
-
-					c = ++c % 2;
-				}
-				if (i % size == 0)
-					s = ++s % 2;
+				u32 sqIdx = ((sY + i) * size + sX) * 4;
+				u32 imgIdx = (i * imgWidth) * 4;
+				memcpy(&cellData1[sqIdx], imgPixels + imgIdx, minW * 4);
+				memcpy(&cellData2[sqIdx], imgPixels + imgIdx, minW * 4);
+
+				// square 2: call shader on the whole row
+				if (shader)
+					shader(sX, sY + i, minW, &cellData2[sqIdx]);
 			}
 
+			// replicate both cells over the frame buffer
+			const u8* cellSrc[2] = { cellData1.data(), cellData2.data() };
+			FillCheckerboardCells(cellSrc, size);
 
 			// cleanup
 			delete[] imgPixels;
 		}
 	}
 
-	void FrameBuffer::invert_pixel_color(u32 p, u8* r, u8* g, u8* b, u8* a)
+	// ---------------------------------------------------------------------------
+	// \fn		ShadeRegion
+	// \brief	Runs a span shader over a rectangle of the frame buffer.
+	void FrameBuffer::ShadeRegion(u32 x, u32 y, u32 w, u32 h, spanShader fn)
 	{
-		*r = 255 - *r;
-		*g = 255 - *g;
-		*b = 255 - *b;
-		*a = *a;
+		if (fn)
+			Rasterizer::ShadeRegion(x, y, w, h, fn);
 	}
-	void FrameBuffer::add_gradient(u32 p, u8* r, u8* g, u8* b, u8* a)
-	{
-		u32 size = 100;
-		u32 x = (p/4) % size;
-		f32 tn = 1.0f-f32(x) / f32(size);
-		Color c; c.FromU32(AE_COLORS_FRENCH_BEIGE);
-		Color pc(*r, *g, *b, *a);
-		c = c * tn * pc;
 
-		*r = min(255, u8(c.r * 255));
-		*g = min(255, u8(c.g * 255));
-		*b = min(255, u8(c.b * 255));
-		*a = min(255, u8(c.a * 255));
+	void FrameBuffer::invert_pixel_color(u32 x, u32 y, u32 count, u8* pixels)
+	{
+		InvertShader()(x, y, count, pixels);
+	}
+	void FrameBuffer::add_gradient(u32 x, u32 y, u32 count, u8* pixels)
+	{
+		GradientShader()(x, y, count, pixels);
 	}
 
-	void FrameBuffer::do_nothing(u32 p, u8* r, u8* g, u8* b, u8* a)
+	void FrameBuffer::do_nothing(u32, u32, u32, u8*)
 	{
 
 	}
@@ -4,18 +4,35 @@
 namespace Rasterizer
 {
 	struct Color; // forward declare the color structure
+	struct Surface; // forward declare the surface structure
 
 	class FrameBuffer
 	{
 	public:
 		// Initialize
-		static bool Allocate(u32 width, u32 height);
+		// pitch is the number of bytes between rows, 0 picks a padded one
+		static bool Allocate(u32 width, u32 height, u32 pitch = 0);
 		static void Delete();
 
-		// Getters
+		// Getters (of the bound view, see below)
 		static u8 *		GetBufferData();
 		static u32		GetWidth();
 		static u32		GetHeight();
+		static u32		GetPitch();
+		static Surface	GetSurface();
+
+		// Views
+		// Every operation works on the bound view: a rectangle of the whole
+		// allocation (the default) or any other surface. Drawing is clipped
+		// to its size. SetPixel/GetPixel (and so all the Draw* functions)
+		// see its top left pixel at (originX, originY), the region
+		// operations (Clear, ShadeRegion, filters...) at (0, 0).
+		static Surface	GetRootSurface();
+		static void		Bind(const Surface& view, u32 originX = 0, u32 originY = 0);
+		static u32		GetOriginX();
+		static u32		GetOriginY();
+		static void		SetViewport(u32 x, u32 y, u32 width, u32 height);
+		static void		ResetViewport();
 
 		// FrameBuffer Operations
 		static void Clear(const Color & c);
@@ -37,17 +54,29 @@ namespace Rasterizer
 		static void LoadFromImageFile(const char* filename);
 
 		// VERY BIG MEGA CHALLENGE
-		typedef void (*pixelShader)(u32 p, u8* r, u8* g, u8* b, u8* a);
-		static void invert_pixel_color(u32 p, u8* r, u8* g, u8* b, u8* a);
-		static void add_gradient(u32 p, u8* r, u8* g, u8* b, u8* a);
-		static void do_nothing(u32 p, u8*r, u8* g, u8* b, u8* a);
-		static void CheckerboardImage(const char* filename, u32 size, pixelShader fn = do_nothing);
+		// shaders process a span of count RGBA pixels starting at (x, y). See PixelShader.h
+		typedef void (*spanShader)(u32 x, u32 y, u32 count, u8* pixels);
+		static void invert_pixel_color(u32 x, u32 y, u32 count, u8* pixels);
+		static void add_gradient(u32 x, u32 y, u32 count, u8* pixels);
+		static void do_nothing(u32 x, u32 y, u32 count, u8* pixels);
+		static void CheckerboardImage(const char* filename, u32 size, spanShader fn = do_nothing);
+		static void ShadeRegion(u32 x, u32 y, u32 w, u32 h, spanShader fn);
 
 		// Private Variables
 	private:
+		// bound view
 		static u8 *		frameBuffer;
 		static u32		frameBufferWidth;
 		static u32		frameBufferHeight;
+		static u32		frameBufferPitch;
+		static u32		frameBufferOriginX;
+		static u32		frameBufferOriginY;
+
+		// whole allocation
+		static u8 *		rootBuffer;
+		static u32		rootWidth;
+		static u32		rootHeight;
+		static u32		rootPitch;
 	};
 }
 
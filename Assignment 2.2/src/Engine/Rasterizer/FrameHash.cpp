@@ -0,0 +1,217 @@
+// ----------------------------------------------------------------------------
+// File Name		:	FrameHash.cpp
+// Purpose			:	Content hashing of frame buffer tiles (xxHash64) used
+//						to skip presenting or saving identical frames.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+
+namespace Rasterizer
+{
+	static const u64 cPrime1 = 11400714785074694791ULL;
+	static const u64 cPrime2 = 14029467366897019727ULL;
+	static const u64 cPrime3 = 1609587929392839161ULL;
+	static const u64 cPrime4 = 9650029242287828579ULL;
+	static const u64 cPrime5 = 2870177450012600261ULL;
+
+	// ------------------------------------------------------------------------
+	/// \fn		Rotl
+	/// \brief	Rotates left by r bits.
+	static u64 Rotl(u64 v, u32 r)
+	{
+		return (v << r) | (v >> (64 - r));
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Read64 / Read32
+	/// \brief	Unaligned little endian reads.
+	static u64 Read64(const u8* p)
+	{
+		u64 v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+	static u64 Read32(const u8* p)
+	{
+		unsigned int v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		MixRound / MergeRound
+	/// \brief	xxHash64 accumulator steps.
+	static u64 MixRound(u64 acc, u64 input)
+	{
+		acc += input * cPrime2;
+		acc = Rotl(acc, 31);
+		return acc * cPrime1;
+	}
+	static u64 MergeRound(u64 acc, u64 val)
+	{
+		acc ^= MixRound(0, val);
+		return acc * cPrime1 + cPrime4;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		HashBytes
+	/// \brief	64 bit xxHash of size bytes. Calls can be chained by passing
+	///			the previous result as the seed.
+	u64 HashBytes(const void* data, size_t size, u64 seed)
+	{
+		const u8* p = static_cast<const u8*>(data);
+		const u8* end = p + size;
+		u64 h;
+
+		// 32 bytes per step in four independent lanes
+		if (size >= 32)
+		{
+			u64 v1 = seed + cPrime1 + cPrime2;
+			u64 v2 = seed + cPrime2;
+			u64 v3 = seed;
+			u64 v4 = seed - cPrime1;
+			do
+			{
+				v1 = MixRound(v1, Read64(p));
+				v2 = MixRound(v2, Read64(p + 8));
+				v3 = MixRound(v3, Read64(p + 16));
+				v4 = MixRound(v4, Read64(p + 24));
+				p += 32;
+			} while (p + 32 <= end);
+
+			h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+			h = MergeRound(h, v1);
+			h = MergeRound(h, v2);
+			h = MergeRound(h, v3);
+			h = MergeRound(h, v4);
+		}
+		else
+			h = seed + cPrime5;
+
+		h += u64(size);
+
+		// tail
+		for (; p + 8 <= end; p += 8)
+			h = Rotl(h ^ MixRound(0, Read64(p)), 27) * cPrime1 + cPrime4;
+		if (p + 4 <= end)
+		{
+			h = Rotl(h ^ (Read32(p) * cPrime1), 23) * cPrime2 + cPrime3;
+			p += 4;
+		}
+		for (; p < end; ++p)
+			h = Rotl(h ^ (*p * cPrime5), 11) * cPrime1;
+
+		// avalanche
+		h ^= h >> 33;
+		h *= cPrime2;
+		h ^= h >> 29;
+		h *= cPrime3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		HashSurface
+	/// \brief	Hash of the pixels of a surface (padding excluded) and its size.
+	u64 HashSurface(const Surface& s)
+	{
+		u32 size[2] = { s.mWidth, s.mHeight };
+		u64 h = HashBytes(size, sizeof(size));
+		if (!s.mPixels)
+			return h;
+
+		// contiguous rows hash in one go
+		u32 rowBytes = s.mWidth * 4;
+		if (s.mPitch == rowBytes)
+			return HashBytes(s.mPixels, size_t(rowBytes) * s.mHeight, h);
+
+		for (u32 y = 0; y < s.mHeight; ++y)
+			h = HashBytes(s.GetRow(y), rowBytes, h);
+		return h;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		TileHashes
+	/// \brief	Starts with no hashes.
+	TileHashes::TileHashes() : mWidth(0), mHeight(0), mTilesX(0), mTilesY(0), mFrameHash(0)
+	{}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Update
+	/// \brief	Hashes every tile of the surface, one batch per row of tiles,
+	///			and compares them with the previous hashes. Returns the number
+	///			of tiles that changed, every tile when the size changed.
+	u32 TileHashes::Update(const Surface& s)
+	{
+		bool resized = s.mWidth != mWidth || s.mHeight != mHeight;
+		if (resized)
+		{
+			mWidth = s.mWidth;
+			mHeight = s.mHeight;
+			mTilesX = (mWidth + cTileSize - 1) / cTileSize;
+			mTilesY = (mHeight + cTileSize - 1) / cTileSize;
+			mHashes.assign(mTilesX * mTilesY, 0);
+		}
+		mChanged.assign(mTilesX * mTilesY, resized ? 1 : 0);
+		if (!s.mPixels || mHashes.empty())
+		{
+			mFrameHash = HashSurface(s);
+			return resized ? u32(mHashes.size()) : 0;
+		}
+
+		ParallelFor(mTilesY, 1, [&](unsigned begin, unsigned end)
+		{
+			for (u32 ty = begin; ty < end; ++ty)
+			{
+				u32 y0 = ty * cTileSize;
+				u32 y1 = min(y0 + cTileSize, mHeight);
+				for (u32 tx = 0; tx < mTilesX; ++tx)
+				{
+					u32 x0 = tx * cTileSize;
+					u32 bytes = (min(x0 + cTileSize, mWidth) - x0) * 4;
+
+					// chain the row segments of the tile
+					u64 h = 0;
+					for (u32 y = y0; y < y1; ++y)
+						h = HashBytes(s.GetPixel(x0, y), bytes, h);
+
+					u32 index = ty * mTilesX + tx;
+					if (h != mHashes[index])
+					{
+						mHashes[index] = h;
+						mChanged[index] = 1;
+					}
+				}
+			}
+		});
+
+		u32 changed = 0;
+		for (u8 c : mChanged)
+			changed += c;
+		u32 size[2] = { mWidth, mHeight };
+		mFrameHash = HashBytes(mHashes.data(), mHashes.size() * sizeof(u64), HashBytes(size, sizeof(size)));
+		return changed;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Reset
+	/// \brief	Forgets the previous hashes, the next Update reports every tile.
+	void TileHashes::Reset()
+	{
+		mWidth = mHeight = 0;
+		mTilesX = mTilesY = 0;
+		mFrameHash = 0;
+		mHashes.clear();
+		mChanged.clear();
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		IsTileChanged
+	/// \brief	Whether the tile changed in the last Update.
+	bool TileHashes::IsTileChanged(u32 tx, u32 ty) const
+	{
+		return tx < mTilesX && ty < mTilesY && mChanged[ty * mTilesX + tx] != 0;
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef CS200_FRAME_HASH_H_
+#define CS200_FRAME_HASH_H_
+
+#include <vector>
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \fn		HashBytes
+	/// \brief	64 bit xxHash of size bytes. Calls can be chained by passing
+	///			the previous result as the seed.
+	u64 HashBytes(const void* data, size_t size, u64 seed = 0);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		HashSurface
+	/// \brief	Hash of the pixels of a surface (padding excluded) and its size.
+	u64 HashSurface(const Surface& s);
+
+	/// -----------------------------------------------------------------------
+	/// \class	TileHashes
+	/// \brief	Remembers one hash per cTileSize x cTileSize tile of a surface
+	///			so consumers (Present, SaveToFile...) can tell whether the
+	///			pixels changed since they last looked at them. Tiles are
+	///			hashed in parallel.
+	class TileHashes
+	{
+	public:
+		static const u32 cTileSize = 64;
+
+		TileHashes();
+
+		// Hashes the surface. Returns the number of tiles that differ from
+		// the previous Update, every tile when the size changed.
+		u32		Update(const Surface& s);
+
+		// Forgets the previous hashes, the next Update reports every tile.
+		void	Reset();
+
+		bool	IsTileChanged(u32 tx, u32 ty) const;
+		u64		GetFrameHash() const { return mFrameHash; }
+		u32		GetTilesX() const { return mTilesX; }
+		u32		GetTilesY() const { return mTilesY; }
+
+	private:
+		u32					mWidth;
+		u32					mHeight;
+		u32					mTilesX;
+		u32					mTilesY;
+		u64					mFrameHash;
+		std::vector<u64>	mHashes;
+		std::vector<u8>		mChanged;
+	};
+}
+
+#endif
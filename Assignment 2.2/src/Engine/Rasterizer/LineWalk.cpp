@@ -0,0 +1,183 @@
+// ----------------------------------------------------------------------------
+// File Name		:	LineWalk.cpp
+// Purpose			:	Integer line setup: 24.8 fixed point end points, octant
+//						mirroring and clipping to the bound view.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+
+namespace Rasterizer
+{
+	// ------------------------------------------------------------------------
+	/// \fn		FloorDiv / CeilDiv
+	/// \brief	Integer division rounding down / up, d > 0.
+	static s64 FloorDiv(s64 n, s64 d)
+	{
+		s64 q = n / d;
+		return (n % d != 0 && n < 0) ? q - 1 : q;
+	}
+	static s64 CeilDiv(s64 n, s64 d)
+	{
+		s64 q = n / d;
+		return (n % d != 0 && n > 0) ? q + 1 : q;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ToFixedN
+	/// \brief	count values to view relative 24.8, 4 at a time through FloorN.
+	static void ToFixedN(const f32* in, s32* out, u32 count, u32 origin)
+	{
+		//floor(fixed / 256) is the pixel Round() picks, truncate shift adds
+		//half a pixel first
+		f32 half = GetRoundMethod() == eRM_TRUNCATE_SHIFT ? 128.0f : 0.0f;
+		const __m128 scale = _mm_set1_ps(256.0f);
+		const __m128 bias = _mm_set1_ps(half);
+
+		f32 scaled[cLineBatch];
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_ps(scaled + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), bias));
+		for (; i < count; ++i)
+			scaled[i] = in[i] * 256.0f + half;
+		FloorN(scaled, reinterpret_cast<int*>(out), count);
+
+		//Out of range values (NaN included) are marked so the setup drops
+		//the line, the rest is moved to the view
+		const s32 limit = s32(cMaxLineCoord) * 256;
+		const s32 shift = s32(origin) * 256;
+		for (i = 0; i < count; ++i)
+			out[i] = (out[i] < -limit || out[i] > limit) ? cLineFixedInvalid : out[i] - shift;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ToLineFixed
+	/// \brief	Converts points to view relative 24.8 fixed point, x and y
+	///			into separate arrays.
+	void ToLineFixed(const AEVec2* points, u32 count, s32* x, s32* y)
+	{
+		u32 ox = FrameBuffer::GetOriginX();
+		u32 oy = FrameBuffer::GetOriginY();
+
+		f32 xs[cLineBatch], ys[cLineBatch];
+		for (u32 begin = 0; begin < count; begin += cLineBatch)
+		{
+			u32 n = min(cLineBatch, count - begin);
+			for (u32 i = 0; i < n; ++i)
+			{
+				xs[i] = points[begin + i].x;
+				ys[i] = points[begin + i].y;
+			}
+			ToFixedN(xs, x + begin, n, ox);
+			ToFixedN(ys, y + begin, n, oy);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetupLineWalk
+	/// \brief	Fills walk for the line p1 -> p2, clipped to the bound view.
+	bool SetupLineWalk(const AEVec2& p1, const AEVec2& p2, LineWalk& walk)
+	{
+		AEVec2 ends[2] = { p1, p2 };
+		s32 x[2], y[2];
+		ToLineFixed(ends, 2, x, y);
+		return SetupLineWalk(x[0], y[0], x[1], y[1], FrameBuffer::GetSurface(), walk);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetupLineWalk
+	/// \brief	Fills walk for the line (x0, y0) -> (x1, y1), in view
+	///			relative 24.8 fixed point, clipped to view.
+	///
+	///			With n major steps, the minor coordinate (24.8) at step k is
+	///			v(k) = v0 + k * dv / n, so its pixel is
+	///			q(k) = floor((v0 * n + k * dv) / (256 * n)) and both end pixels
+	///			are exact. Lines going down the minor axis walk the mirrored
+	///			numerator instead, which keeps q growing. The error term is v(k) * n - 256 * n * (q(k) + 1),
+	///			which lives in [-256 * n, 0). Since the major axis is the
+	///			longer one in pixels, q never moves more than one per step.
+	bool SetupLineWalk(s32 x0, s32 y0, s32 x1, s32 y1, const Surface& view, LineWalk& walk)
+	{
+		walk.mCount = 0;
+
+		if (!view.mPixels || view.mWidth == 0 || view.mHeight == 0)
+			return false;
+		if (x0 == cLineFixedInvalid || y0 == cLineFixedInvalid ||
+			x1 == cLineFixedInvalid || y1 == cLineFixedInvalid)
+			return false;
+
+		//1. Pick the major axis from the pixel deltas
+		walk.mXMajor = abs((x1 >> 8) - (x0 >> 8)) >= abs((y1 >> 8) - (y0 >> 8));
+		s32 m0 = walk.mXMajor ? x0 : y0, m1 = walk.mXMajor ? x1 : y1;	//major axis
+		s32 v0 = walk.mXMajor ? y0 : x0, v1 = walk.mXMajor ? y1 : x1;	//minor axis
+		s32 majorSize = s32(walk.mXMajor ? view.mWidth : view.mHeight);
+		s32 minorSize = s32(walk.mXMajor ? view.mHeight : view.mWidth);
+
+		s32 start = m0 >> 8;						//major pixel of p1
+		s32 n = abs((m1 >> 8) - start);				//major steps
+		walk.mMajorDir = (m1 >> 8) >= start ? 1 : -1;
+		walk.mMinorDir = v1 >= v0 ? 1 : -1;
+
+		//2. Clip the steps k in [0, n] to the view, on the major axis...
+		s64 kBegin = 0, kEnd = n;
+		if (walk.mMajorDir > 0)
+		{
+			kBegin = max(kBegin, s64(-start));
+			kEnd = min(kEnd, s64(majorSize - 1 - start));
+		}
+		else
+		{
+			kBegin = max(kBegin, s64(start - (majorSize - 1)));
+			kEnd = min(kEnd, s64(start));
+		}
+
+		//...and on the minor axis, where the pixel is mMinorDir * q(k)
+		s64 qLow = walk.mMinorDir > 0 ? 0 : -(minorSize - 1);
+		s64 qHigh = walk.mMinorDir > 0 ? minorSize - 1 : 0;
+		s64 den = 256 * s64(max(n, 1));
+		s64 base = s64(v0) * max(n, 1);
+		s64 dv = n ? s64(v1) - v0 : 0;
+
+		//Mirror the minor axis so it always grows. The exact numerator is
+		//mirrored, floor(num / den) = -floor((den - 1 - num) / den), so both
+		//directions of a line take the floor of the same value
+		if (walk.mMinorDir < 0)
+		{
+			base = den - 1 - base;
+			dv = -dv;
+		}
+		if (dv == 0)
+		{
+			s64 q = FloorDiv(base, den);
+			if (q < qLow || q > qHigh)
+				return false;
+		}
+		else
+		{
+			kBegin = max(kBegin, CeilDiv(qLow * den - base, dv));
+			kEnd = min(kEnd, FloorDiv((qHigh + 1) * den - base - 1, dv));
+		}
+		if (kBegin > kEnd)
+			return false;
+
+		//3. State at the first visible step
+		s64 num = base + kBegin * dv;
+		s64 q = FloorDiv(num, den);
+		s32 major = start + walk.mMajorDir * s32(kBegin);
+		s32 minor = walk.mMinorDir * s32(q);
+
+		walk.mX = walk.mXMajor ? major : minor;
+		walk.mY = walk.mXMajor ? minor : major;
+		walk.mPixel = view.GetPixel(u32(walk.mX), u32(walk.mY));
+		walk.mCount = s32(kEnd - kBegin + 1);
+
+		s32 xStep = 4, yStep = s32(view.mPitch);
+		walk.mMajorStep = walk.mMajorDir * (walk.mXMajor ? xStep : yStep);
+		walk.mMinorStep = walk.mMinorDir * (walk.mXMajor ? yStep : xStep);
+
+		walk.mError = s32(num - den * (q + 1));
+		walk.mErrorStep = s32(dv);
+		walk.mErrorReset = s32(den);
+		return true;
+	}
+}
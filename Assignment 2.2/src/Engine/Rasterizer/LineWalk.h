@@ -0,0 +1,75 @@
+#ifndef CS200_LINE_WALK_H_
+#define CS200_LINE_WALK_H_
+
+namespace Rasterizer
+{
+	// end points further than this from the origin are rejected, it keeps
+	// the 24.8 setup math in 32 bits (2^21 pixels)
+	static const f32 cMaxLineCoord = 2097152.0f;
+
+	// points converted at once by ToLineFixed, per batch
+	static const u32 cLineBatch = 256;
+
+	// what ToLineFixed writes for points that are out of range or NaN
+	static const s32 cLineFixedInvalid = s32(0x80000000);
+
+	/// -----------------------------------------------------------------------
+	/// \struct	LineWalk
+	/// \brief	Integer setup of a line, shared by the integer line methods.
+	///			The end points are converted to 24.8 fixed point and the
+	///			line is mirrored so every octant walks the same way: one
+	///			pixel along the major axis per step, plus one along the minor
+	///			axis whenever mError reaches 0. The walk is already clipped to
+	///			the bound view, mPixel is the first visible pixel and mCount
+	///			the number of visible pixels (both end pixels included).
+	///
+	///				for (s32 i = 0; i < walk.mCount; ++i)
+	///				{
+	///					write mPixel;
+	///					mError += mErrorStep;
+	///					if (mError >= 0) { mPixel += mMinorStep; mError -= mErrorReset; }
+	///					mPixel += mMajorStep;
+	///				}
+	struct LineWalk
+	{
+		u8 *	mPixel;			// first visible pixel
+		s32		mCount;			// visible pixels, 0 when the line is not visible
+		s32		mX, mY;			// view coordinates of mPixel
+		bool	mXMajor;		// the major axis is x
+
+		s32		mMajorStep;		// bytes to the next pixel along the major axis
+		s32		mMinorStep;		// bytes to the next pixel along the minor axis
+		s32		mMajorDir;		// +1 or -1, direction along the major axis
+		s32		mMinorDir;		// +1 or -1, direction along the minor axis
+
+		s32		mError;			// always negative between steps
+		s32		mErrorStep;		// added every major step
+		s32		mErrorReset;	// subtracted with every minor step
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetupLineWalk
+	/// \brief	Fills walk for the line p1 -> p2. The end pixels are the ones
+	///			Round() picks for p1 and p2, the pixels in between follow the
+	///			sub-pixel line between them. Returns false (and mCount 0) when
+	///			nothing is visible or an end point is further than
+	///			cMaxLineCoord pixels from the origin.
+	bool SetupLineWalk(const AEVec2& p1, const AEVec2& p2, LineWalk& walk);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ToLineFixed
+	/// \brief	Converts count points to the fixed point SetupLineWalk uses
+	///			(24.8, relative to the bound view, current round method), x
+	///			and y into separate arrays. The scaling and the floor run 4
+	///			values at a time. Out of range points become cLineFixedInvalid.
+	void ToLineFixed(const AEVec2* points, u32 count, s32* x, s32* y);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetupLineWalk
+	/// \brief	Same as above for end points already converted by
+	///			ToLineFixed, clipped to view. Batched callers convert their
+	///			points once and call this per line.
+	bool SetupLineWalk(s32 x0, s32 y0, s32 x1, s32 y1, const Surface& view, LineWalk& walk);
+}
+
+#endif
@@ -0,0 +1,223 @@
+// ----------------------------------------------------------------------------
+// File Name		:	PatternFill.cpp
+// Purpose			:	Fills the frame buffer with repeating patterns. Instead
+//						of computing every pixel, one or two template rows are
+//						built per pattern and copied over the frame buffer rows.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+
+namespace Rasterizer
+{
+	// scratch memory for the template rows, reused every frame
+	static std::vector<u8> sTemplates;
+
+	// rows copied per batch when splitting the fill across threads
+	static const u32 cFillRowBatch = 32;
+
+	// ------------------------------------------------------------------------
+	/// \fn		ToPixel
+	/// \brief	Converts an ARGB color (AE_COLORS_*) to the RGBA byte order
+	///			used by the frame buffer.
+	static void ToPixel(u32 argb, u8* out)
+	{
+		out[0] = u8((argb >> 16) & 0xFF);
+		out[1] = u8((argb >> 8) & 0xFF);
+		out[2] = u8(argb & 0xFF);
+		out[3] = u8((argb >> 24) & 0xFF);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ReplicatePrefix
+	/// \brief	The first periodBytes of row are already set, repeat them until
+	///			rowBytes are filled. Copies double in size every step.
+	static void ReplicatePrefix(u8* row, u32 rowBytes, u32 periodBytes)
+	{
+		u32 filled = min(periodBytes, rowBytes);
+		while (filled < rowBytes)
+		{
+			u32 copy = min(filled, rowBytes - filled);
+			memcpy(row + filled, row, copy);
+			filled += copy;
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FillPixels
+	/// \brief	Sets count pixels starting at dst to the same RGBA value.
+	static void FillPixels(u8* dst, u32 count, const u8* pixel)
+	{
+		if (count == 0)
+			return;
+		memcpy(dst, pixel, 4);
+		ReplicatePrefix(dst, count * 4, 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetTemplates
+	/// \brief	Returns scratch memory for count template rows of the current
+	///			frame buffer width.
+	static u8* GetTemplates(u32 count)
+	{
+		u32 size = count * FrameBuffer::GetWidth() * 4;
+		if (sTemplates.size() < size)
+			sTemplates.resize(size);
+		return sTemplates.data();
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillRowsFromTemplates
+	/// \brief	Core of the pattern fill. Every frame buffer row y is a copy of
+	///			template row (y / rowsPerTemplate) % templateCount.
+	void FillRowsFromTemplates(const u8* templates, u32 templateCount, u32 rowsPerTemplate)
+	{
+		u8* frameBuffer = FrameBuffer::GetBufferData();
+		u32 width = FrameBuffer::GetWidth();
+		u32 height = FrameBuffer::GetHeight();
+		if (!frameBuffer || !templates || width == 0 || templateCount == 0 || rowsPerTemplate == 0)
+			return;
+
+		u32 rowBytes = width * 4;
+		u32 pitch = FrameBuffer::GetPitch();
+		ParallelFor(height, cFillRowBatch, [=](unsigned begin, unsigned end)
+		{
+			for (u32 y = begin; y < end; ++y)
+			{
+				u32 t = (y / rowsPerTemplate) % templateCount;
+				memcpy(frameBuffer + y * pitch, templates + t * rowBytes, rowBytes);
+			}
+		});
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillSolid
+	/// \brief	Fills the whole frame buffer with one color (single template).
+	void FillSolid(u8 r, u8 g, u8 b, u8 a)
+	{
+		if (FrameBuffer::GetWidth() == 0)
+			return;
+
+		u8 pixel[4] = { r, g, b, a };
+		u8* row = GetTemplates(1);
+		FillPixels(row, FrameBuffer::GetWidth(), pixel);
+		FillRowsFromTemplates(row, 1, 1);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillCheckerboard
+	/// \brief	Checkerboard of size x size cells. Colors are ARGB (AE_COLORS_*)
+	///			and the cell at the origin uses colors[0].
+	void FillCheckerboard(const u32 colors[2], u32 size)
+	{
+		u32 width = FrameBuffer::GetWidth();
+		if (size == 0 || width == 0)
+			return;
+
+		u8 pixels[2][4];
+		ToPixel(colors[0], pixels[0]);
+		ToPixel(colors[1], pixels[1]);
+
+		// template 0 starts with colors[0], template 1 with colors[1]
+		u8* templates = GetTemplates(2);
+		u32 rowBytes = width * 4;
+		u32 cell = min(size, width);
+		for (u32 t = 0; t < 2; ++t)
+		{
+			u8* row = templates + t * rowBytes;
+			FillPixels(row, cell, pixels[t]);
+			if (size < width)
+				FillPixels(row + size * 4, min(size, width - size), pixels[1 - t]);
+			ReplicatePrefix(row, rowBytes, size * 8);
+		}
+
+		FillRowsFromTemplates(templates, 2, size);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillStripes
+	/// \brief	Alternating stripes of the given thickness. Colors are ARGB.
+	void FillStripes(const u32 colors[2], u32 thickness, bool vertical)
+	{
+		u32 width = FrameBuffer::GetWidth();
+		if (thickness == 0 || width == 0)
+			return;
+
+		u8 pixels[2][4];
+		ToPixel(colors[0], pixels[0]);
+		ToPixel(colors[1], pixels[1]);
+
+		if (vertical)
+		{
+			// one template row with both colors
+			u8* row = GetTemplates(1);
+			FillPixels(row, min(thickness, width), pixels[0]);
+			if (thickness < width)
+				FillPixels(row + thickness * 4, min(thickness, width - thickness), pixels[1]);
+			ReplicatePrefix(row, width * 4, thickness * 8);
+			FillRowsFromTemplates(row, 1, 1);
+		}
+		else
+		{
+			// one solid template row per color
+			u8* templates = GetTemplates(2);
+			FillPixels(templates, width, pixels[0]);
+			FillPixels(templates + width * 4, width, pixels[1]);
+			FillRowsFromTemplates(templates, 2, thickness);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillTiledImage
+	/// \brief	Repeats an RGBA image over the whole frame buffer starting at
+	///			the origin.
+	void FillTiledImage(const u8* pixels, u32 width, u32 height)
+	{
+		u32 fbWidth = FrameBuffer::GetWidth();
+		if (!pixels || width == 0 || height == 0 || fbWidth == 0)
+			return;
+
+		// one template per image row (only the rows that can be visible)
+		u32 rows = min(height, FrameBuffer::GetHeight());
+		u8* templates = GetTemplates(rows);
+		u32 rowBytes = fbWidth * 4;
+		for (u32 i = 0; i < rows; ++i)
+		{
+			u8* row = templates + i * rowBytes;
+			memcpy(row, pixels + i * width * 4, min(width, fbWidth) * 4);
+			ReplicatePrefix(row, rowBytes, width * 4);
+		}
+
+		FillRowsFromTemplates(templates, height, 1);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillCheckerboardCells
+	/// \brief	Checkerboard whose cells are size x size RGBA images instead of
+	///			flat colors. cells[0] is used at the origin.
+	void FillCheckerboardCells(const u8* cells[2], u32 size)
+	{
+		u32 width = FrameBuffer::GetWidth();
+		if (!cells[0] || !cells[1] || size == 0 || width == 0)
+			return;
+
+		// 2 * size templates: one per cell row and per phase
+		u8* templates = GetTemplates(2 * size);
+		u32 rowBytes = width * 4;
+		u32 cellBytes = size * 4;
+		for (u32 t = 0; t < 2 * size; ++t)
+		{
+			u32 phase = t / size;
+			u32 cellRow = t % size;
+			u8* row = templates + t * rowBytes;
+
+			memcpy(row, cells[phase] + cellRow * cellBytes, min(cellBytes, rowBytes));
+			if (cellBytes < rowBytes)
+				memcpy(row + cellBytes, cells[1 - phase] + cellRow * cellBytes, min(cellBytes, rowBytes - cellBytes));
+			ReplicatePrefix(row, rowBytes, 2 * cellBytes);
+		}
+
+		FillRowsFromTemplates(templates, 2 * size, 1);
+	}
+}
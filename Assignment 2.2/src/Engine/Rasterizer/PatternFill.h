@@ -0,0 +1,45 @@
+#ifndef CS200_PATTERN_FILL_H_
+#define CS200_PATTERN_FILL_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \fn		FillRowsFromTemplates
+	/// \brief	Core of the pattern fill. Every frame buffer row y is a copy of
+	///			template row (y / rowsPerTemplate) % templateCount. Each
+	///			template row is exactly GetWidth() pixels (RGBA bytes), stored
+	///			contiguously (no pitch padding). Rows are copied with memcpy and split across
+	///			threads for large buffers.
+	void FillRowsFromTemplates(const u8* templates, u32 templateCount, u32 rowsPerTemplate);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillSolid
+	/// \brief	Fills the whole frame buffer with one color (single template).
+	void FillSolid(u8 r, u8 g, u8 b, u8 a = 255);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillCheckerboard
+	/// \brief	Checkerboard of size x size cells. Colors are ARGB (AE_COLORS_*)
+	///			and the cell at the origin uses colors[0].
+	void FillCheckerboard(const u32 colors[2], u32 size);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillStripes
+	/// \brief	Alternating stripes of the given thickness. Colors are ARGB.
+	///			Vertical stripes change color along x, horizontal along y.
+	void FillStripes(const u32 colors[2], u32 thickness, bool vertical);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillTiledImage
+	/// \brief	Repeats an RGBA image over the whole frame buffer starting at
+	///			the origin.
+	void FillTiledImage(const u8* pixels, u32 width, u32 height);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FillCheckerboardCells
+	/// \brief	Checkerboard whose cells are size x size RGBA images instead of
+	///			flat colors. cells[0] is used at the origin.
+	void FillCheckerboardCells(const u8* cells[2], u32 size);
+}
+
+#endif
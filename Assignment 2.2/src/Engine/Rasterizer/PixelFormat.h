@@ -0,0 +1,46 @@
+#ifndef CS200_PIXEL_FORMAT_H_
+#define CS200_PIXEL_FORMAT_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \brief	Pixel format policies. The frame buffer stores FormatRGBA8.
+	///			A policy defines
+	///
+	///				Pixel								storage type of one pixel
+	///				Pixel	Pack(u8 r, u8 g, u8 b, u8 a)
+	///				Pixel	Pack(const Color& c)
+	///				void	Unpack(Pixel p, u8* rgba)	to 4 RGBA8 bytes
+	///
+	///			It is resolved at compile time, there is no per pixel switch on
+	///			the format. Colors are converted in the current color space
+	///			(see ColorSpace.h).
+
+	/// -----------------------------------------------------------------------
+	/// \struct	FormatRGBA8
+	/// \brief	8 bits per channel, R G B A in memory. The frame buffer format.
+	struct FormatRGBA8
+	{
+		typedef u32 Pixel;
+
+		static Pixel Pack(u8 r, u8 g, u8 b, u8 a)
+		{
+			u8 bytes[4] = { r, g, b, a };
+			Pixel p;
+			memcpy(&p, bytes, sizeof(p));
+			return p;
+		}
+		static Pixel Pack(const Color& c)
+		{
+			u8 rgba[4];
+			EncodeColors(&c, 1, rgba);
+			return Pack(rgba[0], rgba[1], rgba[2], rgba[3]);
+		}
+		static void Unpack(Pixel p, u8* rgba)
+		{
+			memcpy(rgba, &p, sizeof(p));
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,156 @@
+// ----------------------------------------------------------------------------
+// File Name		:	PixelShader.cpp
+// Purpose			:	Span shaders that need precomputed data.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+
+namespace Rasterizer
+{
+	// ------------------------------------------------------------------------
+	/// \struct	GradientTable
+	/// \brief	8.8 fixed point factor per channel and per x in the period.
+	///			Stored twice so 4 consecutive pixels never wrap around.
+	struct GradientTable
+	{
+		u16 mFactors[2 * GradientShader::cPeriod * 4];
+
+		GradientTable()
+		{
+			Color tint;
+			tint.FromU32(AE_COLORS_FRENCH_BEIGE);
+
+			for (u32 i = 0; i < 2 * GradientShader::cPeriod; ++i)
+			{
+				u32 x = i % GradientShader::cPeriod;
+				f32 tn = 1.0f - f32(x) / f32(GradientShader::cPeriod);
+				mFactors[i * 4] = u16(tint.r * tn * 256.0f + 0.5f);
+				mFactors[i * 4 + 1] = u16(tint.g * tn * 256.0f + 0.5f);
+				mFactors[i * 4 + 2] = u16(tint.b * tn * 256.0f + 0.5f);
+				mFactors[i * 4 + 3] = 256;	// keep alpha
+			}
+		}
+	};
+
+	static const GradientTable& GetGradientTable()
+	{
+		static GradientTable table;
+		return table;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GradientShader
+	/// \brief	pixel = pixel * factor >> 8, four pixels per iteration.
+	void GradientShader::operator()(u32 x, u32, u32 count, u8* pixels) const
+	{
+		const u16* factors = GetGradientTable().mFactors;
+		const __m128i zero = _mm_setzero_si128();
+
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const u16* f = factors + ((x + i) % cPeriod) * 4;
+			__m128i* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+			__m128i px = _mm_loadu_si128(p);
+
+			// widen to 16 bits, scale and narrow back
+			__m128i lo = _mm_unpacklo_epi8(px, zero);
+			__m128i hi = _mm_unpackhi_epi8(px, zero);
+			lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_loadu_si128(reinterpret_cast<const __m128i*>(f))), 8);
+			hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(f + 8))), 8);
+			_mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+		}
+
+		// remainder
+		for (; i < count; ++i)
+		{
+			const u16* f = factors + ((x + i) % cPeriod) * 4;
+			for (u32 k = 0; k < 3; ++k)
+				pixels[i * 4 + k] = u8((pixels[i * 4 + k] * f[k]) >> 8);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ColorGradeShader
+	/// \brief	Bakes the grading curve of each channel into a table.
+	ColorGradeShader::ColorGradeShader(const Color& gain, const Color& lift, f32 gamma)
+	{
+		f32 invGamma = gamma > 0.0f ? 1.0f / gamma : 1.0f;
+		for (u32 k = 0; k < 3; ++k)
+		{
+			for (u32 i = 0; i < 256; ++i)
+			{
+				f32 v = lift.v[k] + gain.v[k] * (f32(i) / 255.0f);
+				v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+				mLut[k][i] = u8(powf(v, invGamma) * 255.0f + 0.5f);
+			}
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ColorGradeShader
+	/// \brief	Three table lookups per pixel.
+	void ColorGradeShader::operator()(u32, u32, u32 count, u8* pixels) const
+	{
+		for (u32 i = 0; i < count; ++i, pixels += 4)
+		{
+			pixels[0] = mLut[0][pixels[0]];
+			pixels[1] = mLut[1][pixels[1]];
+			pixels[2] = mLut[2][pixels[2]];
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ThresholdShader
+	/// \brief	Stores the colors in frame buffer byte order.
+	ThresholdShader::ThresholdShader(u8 threshold, u32 below, u32 above)
+		: mThreshold(threshold)
+	{
+		u8 b[4] = { u8(below >> 16), u8(below >> 8), u8(below), 0 };
+		u8 a[4] = { u8(above >> 16), u8(above >> 8), u8(above), 0 };
+		memcpy(&mBelow, b, 4);
+		memcpy(&mAbove, a, 4);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ThresholdShader
+	/// \brief	luminance = (77 r + 150 g + 29 b) >> 8, four pixels at a time.
+	void ThresholdShader::operator()(u32, u32, u32 count, u8* pixels) const
+	{
+		const __m128i lowBytes = _mm_set1_epi32(0x00FF00FF);
+		const __m128i weightsRB = _mm_set1_epi32((29 << 16) | 77);	// (r, b) pairs
+		const __m128i weightsGA = _mm_set1_epi32(150);				// (g, a) pairs
+		const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+		const __m128i threshold = _mm_set1_epi32((int)mThreshold);
+		const __m128i below = _mm_set1_epi32((int)mBelow);
+		const __m128i above = _mm_set1_epi32((int)mAbove);
+
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+			__m128i px = _mm_loadu_si128(p);
+
+			// 16 bit lanes: (r, b) and (g, a) for every pixel
+			__m128i rb = _mm_and_si128(px, lowBytes);
+			__m128i ga = _mm_and_si128(_mm_srli_epi32(px, 8), lowBytes);
+			__m128i lum = _mm_add_epi32(_mm_madd_epi16(rb, weightsRB), _mm_madd_epi16(ga, weightsGA));
+			lum = _mm_srli_epi32(lum, 8);
+
+			// select and keep alpha
+			__m128i mask = _mm_cmpgt_epi32(lum, threshold);
+			__m128i color = _mm_or_si128(_mm_and_si128(mask, above), _mm_andnot_si128(mask, below));
+			_mm_storeu_si128(p, _mm_or_si128(color, _mm_and_si128(px, alphaMask)));
+		}
+
+		// remainder
+		for (; i < count; ++i)
+		{
+			u8* px = pixels + i * 4;
+			u32 lum = (77 * px[0] + 150 * px[1] + 29 * px[2]) >> 8;
+			u32 color = lum > mThreshold ? mAbove : mBelow;
+			memcpy(px, &color, 3);
+		}
+	}
+}
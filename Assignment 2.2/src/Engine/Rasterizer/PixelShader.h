@@ -0,0 +1,120 @@
+#ifndef CS200_PIXEL_SHADER_H_
+#define CS200_PIXEL_SHADER_H_
+
+#include <emmintrin.h>				// SSE2
+#include "..\Utils\ParallelFor.h"	// ParallelFor
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \brief	Shaders process whole spans of RGBA pixels instead of one pixel
+	///			per call. A shader is either a FrameBuffer::spanShader function
+	///			pointer or any functor with the signature
+	///
+	///				void operator()(u32 x, u32 y, u32 count, u8* pixels) const
+	///
+	///			where pixels points to count RGBA pixels starting at (x, y).
+	///			Functors passed to the ShadeRegion template get inlined into
+	///			the row loop.
+
+	/// -----------------------------------------------------------------------
+	/// \struct	InvertShader
+	/// \brief	Inverts the color channels, alpha is left untouched.
+	struct InvertShader
+	{
+		void operator()(u32, u32, u32 count, u8* pixels) const
+		{
+			const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+
+			// 4 pixels at a time
+			u32 i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+				_mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), mask));
+			}
+
+			// remainder
+			for (; i < count; ++i)
+			{
+				pixels[i * 4] = 255 - pixels[i * 4];
+				pixels[i * 4 + 1] = 255 - pixels[i * 4 + 1];
+				pixels[i * 4 + 2] = 255 - pixels[i * 4 + 2];
+			}
+		}
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \struct	GradientShader
+	/// \brief	Modulates the color channels with a tint that fades out
+	///			horizontally and repeats every cPeriod pixels.
+	///			Alpha is left untouched.
+	struct GradientShader
+	{
+		static const u32 cPeriod = 100;
+
+		void operator()(u32 x, u32 y, u32 count, u8* pixels) const;
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \struct	ColorGradeShader
+	/// \brief	Per channel color grading: out = (lift + gain * in) ^ (1/gamma),
+	///			baked into one 256 entry table per channel at construction.
+	///			Alpha is left untouched.
+	struct ColorGradeShader
+	{
+		ColorGradeShader(const Color& gain, const Color& lift, f32 gamma = 1.0f);
+		void operator()(u32 x, u32 y, u32 count, u8* pixels) const;
+
+		u8 mLut[3][256];
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \struct	ThresholdShader
+	/// \brief	Replaces every pixel whose luminance is above the threshold with
+	///			the above color and the rest with the below color. Colors are
+	///			ARGB (AE_COLORS_*), alpha is left untouched.
+	struct ThresholdShader
+	{
+		ThresholdShader(u8 threshold, u32 below = AE_COLORS_BLACK, u32 above = AE_COLORS_WHITE);
+		void operator()(u32 x, u32 y, u32 count, u8* pixels) const;
+
+		u32 mThreshold;
+		u32 mBelow;		// RGBA byte order
+		u32 mAbove;		// RGBA byte order
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ShadeRegion
+	/// \brief	Runs the shader over the rectangle [x, x+w) x [y, y+h) of the
+	///			frame buffer, clipped to its bounds. Rows are split across
+	///			threads.
+	template <typename Shader>
+	void ShadeRegion(u32 x, u32 y, u32 w, u32 h, const Shader& shader)
+	{
+		Surface target = FrameBuffer::GetSurface();
+		u32 fbWidth = target.mWidth;
+		u32 fbHeight = target.mHeight;
+		if (!target.mPixels || x >= fbWidth || y >= fbHeight)
+			return;
+
+		// clip
+		w = min(w, fbWidth - x);
+		h = min(h, fbHeight - y);
+		if (w == 0 || h == 0)
+			return;
+
+		// split rows so each batch has a few thousand pixels to work on
+		u32 rowBatch = max(1u, 4096u / w);
+		ParallelFor(h, rowBatch, [=, &shader](unsigned begin, unsigned end)
+		{
+			for (u32 row = begin; row < end; ++row)
+			{
+				u32 py = y + row;
+				shader(x, py, w, target.GetPixel(x, py));
+			}
+		});
+	}
+}
+
+#endif
@@ -0,0 +1,96 @@
+// ----------------------------------------------------------------------------
+// File Name		:	PostProcess.cpp
+// Purpose			:	Fused full screen post processing. All the passes run
+//						on a tile while it is still in cache.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+
+namespace Rasterizer
+{
+	// ------------------------------------------------------------------------
+	/// \fn		AddPass
+	/// \brief	Appends a pass at the end of the chain. Returns its index.
+	u32 PostProcessChain::AddPass(const Pass& pass)
+	{
+		mPasses.push_back(pass);
+		return u32(mPasses.size() - 1);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		RemovePass
+	/// \brief	Removes the pass at index, later passes move down by one.
+	void PostProcessChain::RemovePass(u32 index)
+	{
+		if (index < mPasses.size())
+			mPasses.erase(mPasses.begin() + index);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Clear
+	/// \brief	Removes all the passes.
+	void PostProcessChain::Clear()
+	{
+		mPasses.clear();
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetPassCount
+	/// \brief	Number of passes in the chain.
+	u32 PostProcessChain::GetPassCount() const
+	{
+		return u32(mPasses.size());
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Execute
+	/// \brief	Runs the chain over the whole frame buffer.
+	void PostProcessChain::Execute() const
+	{
+		Execute(0, 0, FrameBuffer::GetWidth(), FrameBuffer::GetHeight());
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Execute
+	/// \brief	Runs the chain over [x, x+w) x [y, y+h), clipped to the frame
+	///			buffer. One task per tile; inside a tile every row goes
+	///			through all the passes in order.
+	void PostProcessChain::Execute(u32 x, u32 y, u32 w, u32 h) const
+	{
+		Surface target = FrameBuffer::GetSurface();
+		u32 fbWidth = target.mWidth;
+		u32 fbHeight = target.mHeight;
+		if (mPasses.empty() || !target.mPixels || x >= fbWidth || y >= fbHeight)
+			return;
+
+		// clip
+		w = min(w, fbWidth - x);
+		h = min(h, fbHeight - y);
+
+		u32 tilesX = (w + cTileSize - 1) / cTileSize;
+		u32 tilesY = (h + cTileSize - 1) / cTileSize;
+		const Pass* passes = mPasses.data();
+		u32 passCount = u32(mPasses.size());
+
+		ParallelFor(tilesX * tilesY, 1, [=](unsigned begin, unsigned end)
+		{
+			for (u32 t = begin; t < end; ++t)
+			{
+				// tile bounds
+				u32 tx = x + (t % tilesX) * cTileSize;
+				u32 ty = y + (t / tilesX) * cTileSize;
+				u32 tw = min(cTileSize, x + w - tx);
+				u32 th = min(cTileSize, y + h - ty);
+
+				for (u32 row = ty; row < ty + th; ++row)
+				{
+					u8* pixels = target.GetPixel(tx, row);
+					for (u32 p = 0; p < passCount; ++p)
+						passes[p](tx, row, tw, pixels);
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef CS200_POST_PROCESS_H_
+#define CS200_POST_PROCESS_H_
+
+#include <functional>
+#include <vector>
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \class	PostProcessChain
+	/// \brief	Ordered list of full screen passes. Each pass is a span shader
+	///			(see PixelShader.h) that only reads and writes the pixels it is
+	///			given. Execute walks the frame buffer once, tile by tile, and
+	///			runs every pass on a tile row before moving on, so N passes
+	///			cost one trip through memory instead of N. Tiles are split
+	///			across threads.
+	class PostProcessChain
+	{
+	public:
+		typedef std::function<void(u32 x, u32 y, u32 count, u8* pixels)> Pass;
+
+		// tile dimensions in pixels (64 x 64 RGBA = 16KB, fits in L1)
+		static const u32 cTileSize = 64;
+
+		// Passes
+		u32		AddPass(const Pass& pass);
+		void	RemovePass(u32 index);
+		void	Clear();
+		u32		GetPassCount() const;
+
+		// Runs the chain over the whole frame buffer or over a rectangle.
+		void	Execute() const;
+		void	Execute(u32 x, u32 y, u32 w, u32 h) const;
+
+	private:
+		std::vector<Pass> mPasses;
+	};
+}
+
+#endif
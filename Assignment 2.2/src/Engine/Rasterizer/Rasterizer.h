@@ -6,10 +6,24 @@ struct AEVec2;
 
 // Provided Framework
 #include "Color.h"			// Color
+#include "ColorSpace.h"		// Gamma / sRGB conversions
 #include "FrameBuffer.h"	// Frame buffer
+#include "Surface.h"		// Blit, flip and rotate
+#include "PixelFormat.h"	// Pixel format policies
+#include "Readback.h"		// Bulk reads and region statistics
+#include "FrameHash.h"		// Tile content hashing
+#include "PatternFill.h"	// Frame buffer pattern fills
+#include "PixelShader.h"	// Span shaders
+#include "PostProcess.h"	// Fused post processing chain
+#include "Filters.h"		// Blur and convolution filters
+#include "TiledRenderTarget.h"	// Out of core offscreen rendering
+#include "SparseCanvas.h"	// Sparse tiled canvas
 #include "Rounding.h"		// Rounding
+#include "FixedColor.h"		// Fixed point color stepping
+#include "LineWalk.h"		// Integer line setup
 #include "DrawLine.h"		// Assignment 1 - Line Scan Conversion.
 #include "DrawCircle.h"		// Lab 2 & Extra Credit
+#include "Stroke.h"			// Thick lines and polylines
 #include "Vertex.h"			// Assignment 2 - Triangle Scan Conversion
 #include "DrawTriangle.h"	// Assignment 2 - Triangle Scan Conversion
 
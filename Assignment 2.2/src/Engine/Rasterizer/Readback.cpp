@@ -0,0 +1,270 @@
+// ----------------------------------------------------------------------------
+// File Name		:	Readback.cpp
+// Purpose			:	Bulk frame buffer reads and region reductions. Rows are
+//						split across threads, each batch reduces into its own
+//						partial result and the partials are merged at the end.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+#include <emmintrin.h>
+#include <mutex>
+
+namespace Rasterizer
+{
+	// rows per batch when splitting a reduction across threads
+	static const u32 cReduceRowBatch = 16;
+
+	// ------------------------------------------------------------------------
+	/// \fn		InsideFrameBuffer
+	/// \brief	Whether the rectangle is non empty and fully inside.
+	static bool InsideFrameBuffer(u32 x, u32 y, u32 w, u32 h)
+	{
+		u32 fbWidth = FrameBuffer::GetWidth();
+		u32 fbHeight = FrameBuffer::GetHeight();
+		return FrameBuffer::GetBufferData() && w != 0 && h != 0 &&
+			x < fbWidth && y < fbHeight && w <= fbWidth - x && h <= fbHeight - y;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		RowPointer
+	/// \brief	Address of pixel (x, y) of the frame buffer.
+	static const u8* RowPointer(u32 x, u32 y)
+	{
+		return FrameBuffer::GetSurface().GetPixel(x, y);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ReadPixels
+	/// \brief	RGBA bytes to ARGB words: swap the r and b bytes of every pixel.
+	bool ReadPixels(u32 x, u32 y, u32 w, u32 h, u32* out)
+	{
+		if (!out || !InsideFrameBuffer(x, y, w, h))
+			return false;
+
+		ParallelFor(h, cReduceRowBatch, [=](unsigned begin, unsigned end)
+		{
+			const __m128i keep = _mm_set1_epi32(0xFF00FF00);
+			for (u32 j = begin; j < end; ++j)
+			{
+				const u8* src = RowPointer(x, y + j);
+				u32* dst = out + j * w;
+
+				// 4 pixels at a time
+				u32 i = 0;
+				for (; i + 4 <= w; i += 4)
+				{
+					__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+					__m128i rb = _mm_andnot_si128(keep, p);
+					rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_and_si128(p, keep), rb));
+				}
+
+				// remainder
+				for (; i < w; ++i)
+				{
+					const u8* p = src + i * 4;
+					dst[i] = (u32(p[3]) << 24) | (u32(p[0]) << 16) | (u32(p[1]) << 8) | u32(p[2]);
+				}
+			}
+		});
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ReadPixels
+	/// \brief	Decodes whole rows in the current color space (DecodePixels).
+	bool ReadPixels(u32 x, u32 y, u32 w, u32 h, Color* out)
+	{
+		if (!out || !InsideFrameBuffer(x, y, w, h))
+			return false;
+
+		ParallelFor(h, cReduceRowBatch, [=](unsigned begin, unsigned end)
+		{
+			for (u32 j = begin; j < end; ++j)
+				DecodePixels(RowPointer(x, y + j), w, out + j * w);
+		});
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ComputeRegionStats
+	/// \brief	Min and max are kept per byte over 4 pixels at a time, sums
+	///			are kept per channel in 32 bit lanes for every row and added
+	///			to 64 bit totals.
+	bool ComputeRegionStats(u32 x, u32 y, u32 w, u32 h, RegionStats& stats)
+	{
+		if (!InsideFrameBuffer(x, y, w, h))
+			return false;
+
+		std::mutex lock;
+		u8 minimum[16], maximum[16];
+		memset(minimum, 0xFF, sizeof(minimum));
+		memset(maximum, 0, sizeof(maximum));
+		u64 sums[4] = { 0, 0, 0, 0 };
+
+		ParallelFor(h, cReduceRowBatch, [&](unsigned begin, unsigned end)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			__m128i lo = _mm_set1_epi8(-1);
+			__m128i hi = _mm_setzero_si128();
+			u64 partial[4] = { 0, 0, 0, 0 };
+
+			for (u32 j = begin; j < end; ++j)
+			{
+				const u8* src = RowPointer(x, y + j);
+				__m128i rowSum = _mm_setzero_si128();
+
+				// 4 pixels at a time
+				u32 i = 0;
+				for (; i + 4 <= w; i += 4)
+				{
+					__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+					lo = _mm_min_epu8(lo, p);
+					hi = _mm_max_epu8(hi, p);
+
+					// pixels 0+2 and 1+3 per channel, then widened and added
+					__m128i pairs = _mm_add_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpackhi_epi8(p, zero));
+					rowSum = _mm_add_epi32(rowSum, _mm_unpacklo_epi16(pairs, zero));
+					rowSum = _mm_add_epi32(rowSum, _mm_unpackhi_epi16(pairs, zero));
+				}
+
+				// remainder, replicated to every lane so the min/max stay valid
+				for (; i < w; ++i)
+				{
+					s32 packed;
+					memcpy(&packed, src + i * 4, 4);
+					__m128i p = _mm_set1_epi32(packed);
+					lo = _mm_min_epu8(lo, p);
+					hi = _mm_max_epu8(hi, p);
+					rowSum = _mm_add_epi32(rowSum, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero));
+				}
+
+				u32 s[4];
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(s), rowSum);
+				for (u32 c = 0; c < 4; ++c)
+					partial[c] += s[c];
+			}
+
+			// merge
+			u8 l[16], m[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(l), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(m), hi);
+			std::lock_guard<std::mutex> guard(lock);
+			for (u32 b = 0; b < 16; ++b)
+			{
+				minimum[b] = min(minimum[b], l[b]);
+				maximum[b] = max(maximum[b], m[b]);
+			}
+			for (u32 c = 0; c < 4; ++c)
+				sums[c] += partial[c];
+		});
+
+		// fold the 4 pixel lanes
+		stats.mPixelCount = w * h;
+		for (u32 c = 0; c < 4; ++c)
+		{
+			stats.mMin[c] = min(min(minimum[c], minimum[c + 4]), min(minimum[c + 8], minimum[c + 12]));
+			stats.mMax[c] = max(max(maximum[c], maximum[c + 4]), max(maximum[c + 8], maximum[c + 12]));
+			stats.mMean[c] = f32(f64(sums[c]) / f64(stats.mPixelCount));
+		}
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ComputeHistogram
+	/// \brief	Scatter increments do not vectorize with SSE2, instead every
+	///			batch counts into its own table (no sharing between threads)
+	///			and the tables are added at the end.
+	bool ComputeHistogram(u32 x, u32 y, u32 w, u32 h, u32 histogram[4][256])
+	{
+		if (!histogram || !InsideFrameBuffer(x, y, w, h))
+			return false;
+
+		std::mutex lock;
+		memset(histogram, 0, sizeof(u32) * 4 * 256);
+
+		ParallelFor(h, cReduceRowBatch, [&](unsigned begin, unsigned end)
+		{
+			std::vector<u32> local(4 * 256, 0);
+			u32* r = local.data();
+			u32* g = r + 256;
+			u32* b = g + 256;
+			u32* a = b + 256;
+
+			for (u32 j = begin; j < end; ++j)
+			{
+				const u8* src = RowPointer(x, y + j);
+				for (u32 i = 0; i < w; ++i, src += 4)
+				{
+					++r[src[0]];
+					++g[src[1]];
+					++b[src[2]];
+					++a[src[3]];
+				}
+			}
+
+			// merge
+			std::lock_guard<std::mutex> guard(lock);
+			for (u32 c = 0; c < 4; ++c)
+				for (u32 v = 0; v < 256; ++v)
+					histogram[c][v] += local[c * 256 + v];
+		});
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		CountPixelsEqual
+	/// \brief	Compares 4 pixels at a time and counts the bits of the mask.
+	u32 CountPixelsEqual(u32 x, u32 y, u32 w, u32 h, u8 r, u8 g, u8 b, u8 a)
+	{
+		if (!InsideFrameBuffer(x, y, w, h))
+			return 0;
+
+		const u8 color[4] = { r, g, b, a };
+		s32 packed;
+		memcpy(&packed, color, 4);
+
+		std::mutex lock;
+		u32 count = 0;
+		ParallelFor(h, cReduceRowBatch, [&](unsigned begin, unsigned end)
+		{
+			// set bits in a 4 bit mask
+			static const u8 cBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+			const __m128i target = _mm_set1_epi32(packed);
+			u32 partial = 0;
+
+			for (u32 j = begin; j < end; ++j)
+			{
+				const u8* src = RowPointer(x, y + j);
+
+				// 4 pixels at a time
+				u32 i = 0;
+				for (; i + 4 <= w; i += 4)
+				{
+					__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+					partial += cBits[_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(p, target)))];
+				}
+
+				// remainder
+				for (; i < w; ++i)
+					partial += memcmp(src + i * 4, color, 4) == 0;
+			}
+
+			std::lock_guard<std::mutex> guard(lock);
+			count += partial;
+		});
+		return count;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		CountPixelsEqual
+	/// \brief	Converts the color like FrameBuffer::SetPixel does.
+	u32 CountPixelsEqual(u32 x, u32 y, u32 w, u32 h, const Color& c)
+	{
+		u8 rgba[4];
+		EncodeColors(&c, 1, rgba);
+		return CountPixelsEqual(x, y, w, h, rgba[0], rgba[1], rgba[2], rgba[3]);
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef CS200_READBACK_H_
+#define CS200_READBACK_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \brief	Bulk reads of the frame buffer. All the functions work on the
+	///			rectangle [x, x+w) x [y, y+h), which must be fully inside the
+	///			frame buffer (they return false / 0 otherwise). Outputs are
+	///			row major, w * h entries.
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ReadPixels
+	/// \brief	Copies the rectangle out as packed ARGB colors (the AE_COLORS_*
+	///			format used by Color::FromU32/ToU32).
+	bool ReadPixels(u32 x, u32 y, u32 w, u32 h, u32* out);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ReadPixels
+	/// \brief	Copies the rectangle out as colors in [0, 1].
+	bool ReadPixels(u32 x, u32 y, u32 w, u32 h, Color* out);
+
+	/// -----------------------------------------------------------------------
+	/// \struct	RegionStats
+	/// \brief	Per channel (r, g, b, a) minimum, maximum and mean of a region.
+	struct RegionStats
+	{
+		u8		mMin[4];
+		u8		mMax[4];
+		f32		mMean[4];		// in [0, 255]
+		u32		mPixelCount;
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ComputeRegionStats
+	/// \brief	Min, max and mean of every channel in one pass.
+	bool ComputeRegionStats(u32 x, u32 y, u32 w, u32 h, RegionStats& stats);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ComputeHistogram
+	/// \brief	histogram[c][v] is the number of pixels whose channel c
+	///			(r, g, b, a) is v.
+	bool ComputeHistogram(u32 x, u32 y, u32 w, u32 h, u32 histogram[4][256]);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		CountPixelsEqual
+	/// \brief	Number of pixels exactly equal to the given color (all four
+	///			channels). The Color overload converts like SetPixel.
+	u32 CountPixelsEqual(u32 x, u32 y, u32 w, u32 h, u8 r, u8 g, u8 b, u8 a = 255);
+	u32 CountPixelsEqual(u32 x, u32 y, u32 w, u32 h, const Color& c);
+}
+
+#endif
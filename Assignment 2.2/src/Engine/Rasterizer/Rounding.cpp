@@ -1,6 +1,7 @@
 #include <AEEngine.h>
 #include "Rasterizer.h"
 #include <math.h>
+#include <emmintrin.h>	// SSE2
 
 namespace Rasterizer
 {
@@ -68,4 +69,39 @@ namespace Rasterizer
 			return Truncate(p);
 		}
 	}
-}
\ No newline at end of file
+
+	// ------------------------------------------------------------------------
+	/// \fn		FloorPS
+	/// \brief	Floors 4 floats. cvttps rounds toward zero, so the lanes where
+	///			that landed above the input (negative non integers) get 1
+	///			subtracted: the compare mask is -1 there.
+	static __m128i FloorPS(__m128 v)
+	{
+		__m128i i = _mm_cvttps_epi32(v);
+		__m128 above = _mm_cmpgt_ps(_mm_cvtepi32_ps(i), v);
+		return _mm_add_epi32(i, _mm_castps_si128(above));
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FloorN
+	/// \brief	Array version of Floor, 4 floats at a time. The remainder
+	///			goes through a zero padded register so the tail gets the same
+	///			results as the body.
+	void FloorN(const f32* in, int* out, u32 count)
+	{
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), FloorPS(_mm_loadu_ps(in + i)));
+
+		if (i < count)
+		{
+			f32 tailIn[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			int tailOut[4];
+			for (u32 j = 0; i + j < count; ++j)
+				tailIn[j] = in[i + j];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(tailOut), FloorPS(_mm_loadu_ps(tailIn)));
+			for (u32 j = 0; i + j < count; ++j)
+				out[i + j] = tailOut[j];
+		}
+	}
+}
@@ -29,6 +29,13 @@ namespace Rasterizer
 	/// \brief	Round method (wrapper around either Truncate or Truncate Shift
 	int Round(const float &p);
 
+	/// -----------------------------------------------------------------------
+	/// \fn		FloorN
+	/// \brief	Array version of Floor. Converts count floats from in to ints
+	///			in out, 4 at a time with SSE2. Results match Floor for values
+	///			that fit in an int. in and out need no alignment.
+	void FloorN(const f32* in, int* out, u32 count);
+
 	/// -----------------------------------------------------------------------
 	/// enum	ERoundMethod	
 	/// \brief	Used to determine which rounding method to use.
@@ -43,6 +50,44 @@ namespace Rasterizer
 	///	\fn		SetRoundMethod
 	///	\brief	Sets the current round method of the rasterizer
 	void SetRoundMethod(ERoundMethod rm);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FastFloor
+	/// \brief	Inline floor for values that fit in an int.
+	inline int FastFloor(f32 p)
+	{
+		int i = int(p);
+		return i - (f32(i) > p ? 1 : 0);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \struct	RoundTruncate / RoundTruncateShift
+	/// \brief	Compile time versions of the round methods. The per pixel
+	///			loops are templates on one of these so Apply inlines to a
+	///			floor (or floor + 0.5) with no switch.
+	struct RoundTruncate
+	{
+		static int Apply(f32 p) { return FastFloor(p); }
+	};
+	struct RoundTruncateShift
+	{
+		static int Apply(f32 p) { return FastFloor(p + 0.5f); }
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DispatchRoundMethod
+	/// \brief	Calls fn with the policy matching the current round method,
+	///			once per primitive:
+	///
+	///				DispatchRoundMethod([&](auto rounding) { Body(rounding, ...); });
+	template <typename Fn>
+	void DispatchRoundMethod(Fn fn)
+	{
+		if (GetRoundMethod() == eRM_TRUNCATE_SHIFT)
+			fn(RoundTruncateShift());
+		else
+			fn(RoundTruncate());
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,309 @@
+// ----------------------------------------------------------------------------
+// File Name		:	SparseCanvas.cpp
+// Purpose			:	Sparse tiled canvas. Tiles are aligned pool blocks kept
+//						in a hash map keyed by tile coordinates, shared with
+//						the undo history and copied on write.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\AlignedPool.h"
+#include "..\Utils\ParallelFor.h"
+
+namespace Rasterizer
+{
+	// bytes per tile
+	static const u32 cCanvasTileBytes = SparseCanvas::cTileSize * SparseCanvas::cTileSize * 4;
+
+	// ------------------------------------------------------------------------
+	/// \fn		TileCoord
+	/// \brief	Tile containing canvas coordinate v (rounds towards -infinity).
+	static s32 TileCoord(f32 v)
+	{
+		return s32(floorf(v / f32(SparseCanvas::cTileSize)));
+	}
+
+	CanvasTile::CanvasTile()
+		: mPixels(static_cast<u8*>(AlignedPoolAlloc(cCanvasTileBytes)))
+	{}
+
+	CanvasTile::~CanvasTile()
+	{
+		AlignedPoolFree(mPixels);
+	}
+
+	SparseCanvas::SparseCanvas()
+	{
+		SetBackground(255, 255, 255);
+	}
+
+	SparseCanvas::~SparseCanvas()
+	{}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Clear
+	/// \brief	Removes every tile (undoable, the history keeps them alive).
+	void SparseCanvas::Clear()
+	{
+		for (auto& tile : mTiles)
+			Track(tile.first, tile.second);
+		mTiles.clear();
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SetBackground
+	/// \brief	Color of the canvas where nothing was drawn. Set it before
+	///			drawing, existing tiles are not updated.
+	void SparseCanvas::SetBackground(u8 r, u8 g, u8 b, u8 a)
+	{
+		mBackground[0] = r;
+		mBackground[1] = g;
+		mBackground[2] = b;
+		mBackground[3] = a;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		GetTileCount
+	/// \brief	Number of allocated tiles.
+	u32 SparseCanvas::GetTileCount() const
+	{
+		return u32(mTiles.size());
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Draw
+	/// \brief	Binds every tile overlapping the bounds in turn and runs the
+	///			callback on it. Tiles created for the call are dropped again
+	///			if nothing was drawn on them (e.g. inside a circle outline).
+	///			A tile still referenced by the history is copied first, and
+	///			the copy is dropped if the callback left it unchanged.
+	void SparseCanvas::Draw(const AEVec2& boundsMin, const AEVec2& boundsMax, const DrawCallback& draw)
+	{
+		if (!draw)
+			return;
+
+		Surface previous = FrameBuffer::GetSurface();
+		u32 previousX = FrameBuffer::GetOriginX();
+		u32 previousY = FrameBuffer::GetOriginY();
+
+		s32 tx0 = TileCoord(boundsMin.x), tx1 = TileCoord(boundsMax.x);
+		s32 ty0 = TileCoord(boundsMin.y), ty1 = TileCoord(boundsMax.y);
+		for (s32 ty = ty0; ty <= ty1; ++ty)
+		{
+			for (s32 tx = tx0; tx <= tx1; ++tx)
+			{
+				u64 key = GetKey(tx, ty);
+				auto it = mTiles.find(key);
+				bool created = it == mTiles.end();
+				CanvasTilePtr source = created ? NULL : it->second;
+
+				// copy on write: the pixels are kept when anyone but mTiles
+				// holds them (the history), or when they are about to become
+				// the before state of the pending changes. Checked before
+				// Track, which adds that reference
+				bool shared = !created && (source.use_count() > 2 || mPending.find(key) == mPending.end());
+				Track(key, source);
+
+				CanvasTilePtr tile = (created || shared) ? CreateTile(source ? source->mPixels : NULL) : source;
+				if (!tile->mPixels)
+					continue;
+
+				FrameBuffer::Bind(Surface(tile->mPixels, cTileSize, cTileSize));
+				draw(AEVec2(-f32(tx) * cTileSize, -f32(ty) * cTileSize));
+
+				// a copy nothing was drawn on is dropped, so the tile does
+				// not show up as a change
+				if (created ? IsBackground(tile->mPixels) : (shared && !memcmp(tile->mPixels, source->mPixels, cCanvasTileBytes)))
+					continue;
+				mTiles[key] = tile;
+			}
+		}
+
+		FrameBuffer::Bind(previous, previousX, previousY);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Present
+	/// \brief	Clears the frame buffer to the background and resamples the
+	///			visible tiles (nearest neighbor, 16.16 fixed point steps along
+	///			the rows). Tiles cover disjoint screen rectangles so they are
+	///			split across threads.
+	void SparseCanvas::Present(const AEVec2& pan, f32 zoom) const
+	{
+		Surface target = FrameBuffer::GetSurface();
+		if (!target.mPixels || zoom <= 0.0f)
+			return;
+
+		FrameBuffer::Clear(mBackground[0], mBackground[1], mBackground[2], mBackground[3]);
+
+		// visible allocated tiles
+		f32 invZoom = 1.0f / zoom;
+		s32 tx0 = TileCoord(pan.x), tx1 = TileCoord(pan.x + target.mWidth * invZoom);
+		s32 ty0 = TileCoord(pan.y), ty1 = TileCoord(pan.y + target.mHeight * invZoom);
+		std::vector<std::pair<AEVec2, const u8*>> visible;
+		visible.reserve(mTiles.size());
+		if (size_t(tx1 - tx0 + 1) * size_t(ty1 - ty0 + 1) < mTiles.size())
+		{
+			for (s32 ty = ty0; ty <= ty1; ++ty)
+				for (s32 tx = tx0; tx <= tx1; ++tx)
+				{
+					auto it = mTiles.find(GetKey(tx, ty));
+					if (it != mTiles.end())
+						visible.push_back({ AEVec2(f32(tx) * cTileSize, f32(ty) * cTileSize), it->second->mPixels });
+				}
+		}
+		else
+		{
+			for (auto& tile : mTiles)
+			{
+				s32 tx = s32(u32(tile.first >> 32)), ty = s32(u32(tile.first));
+				if (tx >= tx0 && tx <= tx1 && ty >= ty0 && ty <= ty1)
+					visible.push_back({ AEVec2(f32(tx) * cTileSize, f32(ty) * cTileSize), tile.second->mPixels });
+			}
+		}
+
+		ParallelFor(u32(visible.size()), 1, [&](unsigned begin, unsigned end)
+		{
+			for (u32 t = begin; t < end; ++t)
+			{
+				const AEVec2& corner = visible[t].first;
+				const u8* pixels = visible[t].second;
+
+				// frame buffer pixels whose centers fall inside the tile
+				f32 sx0 = ceilf((corner.x - pan.x) * zoom - 0.5f);
+				f32 sy0 = ceilf((corner.y - pan.y) * zoom - 0.5f);
+				f32 sx1 = ceilf((corner.x + cTileSize - pan.x) * zoom - 0.5f);
+				f32 sy1 = ceilf((corner.y + cTileSize - pan.y) * zoom - 0.5f);
+				u32 x0 = u32(max(sx0, 0.0f)), x1 = u32(min(max(sx1, 0.0f), f32(target.mWidth)));
+				u32 y0 = u32(max(sy0, 0.0f)), y1 = u32(min(max(sy1, 0.0f), f32(target.mHeight)));
+				if (x0 >= x1 || y0 >= y1)
+					continue;
+
+				// texel position of the first pixel center and step, 16.16
+				f32 u0 = pan.x - corner.x + (x0 + 0.5f) * invZoom;
+				s32 u = s32(u0 * 65536.0f);
+				s32 du = s32(invZoom * 65536.0f);
+				for (u32 y = y0; y < y1; ++y)
+				{
+					s32 v = s32(pan.y - corner.y + (y + 0.5f) * invZoom);
+					const u32* src = reinterpret_cast<const u32*>(pixels + min(max(v, 0), s32(cTileSize) - 1) * cTileSize * 4);
+					u32* dst = reinterpret_cast<u32*>(target.GetPixel(0, y));
+
+					// 1:1, straight copy
+					if (du == 65536 && (u >> 16) >= 0 && (u >> 16) + s32(x1 - x0) <= s32(cTileSize))
+					{
+						memcpy(dst + x0, src + (u >> 16), (x1 - x0) * 4);
+						continue;
+					}
+
+					s32 ux = u;
+					for (u32 x = x0; x < x1; ++x, ux += du)
+						dst[x] = src[min(max(ux >> 16, 0), s32(cTileSize) - 1)];
+				}
+			}
+		});
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		TakeChanges
+	/// \brief	Tiles changed since the last call, with their old and new
+	///			pixels. Tiles that ended up as they were are left out.
+	CanvasDelta SparseCanvas::TakeChanges()
+	{
+		CanvasDelta delta;
+		delta.reserve(mPending.size());
+		for (auto& pending : mPending)
+		{
+			auto it = mTiles.find(pending.first);
+			CanvasTilePtr after = it == mTiles.end() ? NULL : it->second;
+			if (after != pending.second)
+				delta.push_back({ pending.first, pending.second, after });
+		}
+		mPending.clear();
+		return delta;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Undo
+	/// \brief	Puts back the tiles as they were before the delta.
+	void SparseCanvas::Undo(const CanvasDelta& delta)
+	{
+		mPending.clear();
+		for (auto& change : delta)
+		{
+			if (change.mBefore)
+				mTiles[change.mKey] = change.mBefore;
+			else
+				mTiles.erase(change.mKey);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Redo
+	/// \brief	Puts back the tiles as they were after the delta.
+	void SparseCanvas::Redo(const CanvasDelta& delta)
+	{
+		mPending.clear();
+		for (auto& change : delta)
+		{
+			if (change.mAfter)
+				mTiles[change.mKey] = change.mAfter;
+			else
+				mTiles.erase(change.mKey);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetKey
+	/// \brief	Hash map key of a tile.
+	u64 SparseCanvas::GetKey(s32 tx, s32 ty)
+	{
+		return (u64(u32(tx)) << 32) | u64(u32(ty));
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		CreateTile
+	/// \brief	New tile, a copy of source or filled with the background.
+	CanvasTilePtr SparseCanvas::CreateTile(const u8* source)
+	{
+		CanvasTilePtr tile = std::make_shared<CanvasTile>();
+		u8* pixels = tile->mPixels;
+		if (!pixels)
+			return tile;
+
+		if (source)
+		{
+			memcpy(pixels, source, cCanvasTileBytes);
+			return tile;
+		}
+
+		memcpy(pixels, mBackground, 4);
+		for (u32 filled = 4; filled < cCanvasTileBytes; filled *= 2)
+			memcpy(pixels + filled, pixels, min(filled, cCanvasTileBytes - filled));
+		return tile;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Track
+	/// \brief	Remembers how a tile was before its first change since the
+	///			last TakeChanges.
+	void SparseCanvas::Track(u64 key, const CanvasTilePtr& current)
+	{
+		if (mPending.find(key) == mPending.end())
+			mPending[key] = current;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		IsBackground
+	/// \brief	Whether every pixel of the tile is the background color.
+	bool SparseCanvas::IsBackground(const u8* pixels) const
+	{
+		u32 background;
+		memcpy(&background, mBackground, 4);
+		const u32* p = reinterpret_cast<const u32*>(pixels);
+		for (u32 i = 0; i < cTileSize * cTileSize; ++i)
+			if (p[i] != background)
+				return false;
+		return true;
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef CS200_SPARSE_CANVAS_H_
+#define CS200_SPARSE_CANVAS_H_
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \struct	CanvasTile
+	/// \brief	Pixels of one canvas tile. Tiles are shared (reference counted)
+	///			between the canvas and the undo history and are copied before
+	///			being written if anyone else still holds them.
+	struct CanvasTile
+	{
+		CanvasTile();
+		~CanvasTile();
+
+		u8*		mPixels;
+
+	private:
+		CanvasTile(const CanvasTile&);
+		CanvasTile& operator=(const CanvasTile&);
+	};
+	typedef std::shared_ptr<CanvasTile> CanvasTilePtr;
+
+	/// -----------------------------------------------------------------------
+	/// \struct	CanvasTileChange
+	/// \brief	One tile before and after a step (NULL when it did not exist).
+	struct CanvasTileChange
+	{
+		u64				mKey;
+		CanvasTilePtr	mBefore;
+		CanvasTilePtr	mAfter;
+	};
+	typedef std::vector<CanvasTileChange> CanvasDelta;
+
+	/// -----------------------------------------------------------------------
+	/// \class	SparseCanvas
+	/// \brief	Unbounded drawing surface (canvas coordinates can be negative)
+	///			stored as a sparse map of cTileSize square tiles at 1:1 scale.
+	///			Only tiles that end up holding drawn pixels are kept, the rest
+	///			of the canvas reads as the background color.
+	///
+	///			Primitives are rasterized into the tiles once with Draw, and
+	///			Present resamples the visible tiles into the frame buffer for
+	///			any pan and zoom.
+	///
+	///			Every change to the tiles is tracked. TakeChanges returns the
+	///			tiles modified since its last call (before and after, sharing
+	///			the pixels with the canvas), which Undo and Redo put back.
+	class SparseCanvas
+	{
+	public:
+		// Called once per tile with the tile bound as the frame buffer. Add
+		// offset to canvas coordinates to get frame buffer coordinates.
+		typedef std::function<void(const AEVec2& offset)> DrawCallback;
+
+		// tile width and height in pixels
+		static const u32 cTileSize = 256;
+
+		SparseCanvas();
+		~SparseCanvas();
+
+		// Tiles
+		void	Clear();
+		void	SetBackground(u8 r, u8 g, u8 b, u8 a = 255);
+		u32		GetTileCount() const;
+
+		// Draws into every tile overlapping [boundsMin, boundsMax] (canvas
+		// coordinates), which must contain everything the callback draws.
+		// The callback runs once per tile and only the pixel writes are
+		// clipped to it, so a primitive costs its setup and walk once per
+		// overlapped tile. Fine for hand drawn primitives, not for huge ones.
+		void	Draw(const AEVec2& boundsMin, const AEVec2& boundsMax, const DrawCallback& draw);
+
+		// Fills the bound frame buffer with the canvas: frame buffer pixel
+		// (x, y) shows canvas point pan + (x + 0.5, y + 0.5) / zoom.
+		void	Present(const AEVec2& pan, f32 zoom) const;
+
+		// History. Undo/Redo drop the changes not taken yet.
+		CanvasDelta	TakeChanges();
+		void		Undo(const CanvasDelta& delta);
+		void		Redo(const CanvasDelta& delta);
+
+	private:
+		static u64		GetKey(s32 tx, s32 ty);
+		CanvasTilePtr	CreateTile(const u8* source);
+		bool			IsBackground(const u8* pixels) const;
+		void			Track(u64 key, const CanvasTilePtr& current);
+
+		// no copies
+		SparseCanvas(const SparseCanvas&);
+		SparseCanvas& operator=(const SparseCanvas&);
+
+		u8									mBackground[4];
+		std::unordered_map<u64, CanvasTilePtr>	mTiles;
+		std::unordered_map<u64, CanvasTilePtr>	mPending;	// tiles changed since TakeChanges, as they were before
+	};
+}
+
+#endif
@@ -0,0 +1,229 @@
+// ----------------------------------------------------------------------------
+// File Name		:	Stroke.cpp
+// Purpose			:	Thick lines and polylines. Strokes are expanded into
+//						convex polygons (segment quads, join wedges, square
+//						caps) and discs (round joins and caps), filled one
+//						solid span per row.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\AlignedPool.h"
+
+namespace Rasterizer
+{
+	// largest polygon FillConvex is given (a mitered wedge)
+	static const u32 cMaxConvexPoints = 4;
+
+	// polylines up to this many points are set up on the stack, longer ones
+	// in an aligned pool block
+	static const u32 cStackStrokePoints = 64;
+
+	// ------------------------------------------------------------------------
+	/// \fn		FillConvex
+	/// \brief	Fills the pixels whose centers are inside the convex polygon,
+	///			same rule as FillCircle: centers in (min, max] on both axes.
+	///			Edges are always evaluated from their lower end, so two
+	///			polygons sharing an edge split its pixels exactly.
+	static void FillConvex(const AEVec2* pts, u32 count, u32 pixel)
+	{
+		f32 yMin = pts[0].y, yMax = pts[0].y;
+		for (u32 i = 1; i < count; ++i)
+		{
+			yMin = min(yMin, pts[i].y);
+			yMax = max(yMax, pts[i].y);
+		}
+
+		//Rows whose centers are inside, limited to the bound view
+		s32 viewTop = s32(FrameBuffer::GetOriginY());
+		s32 yBegin = max(FastFloor(yMin - 0.5f) + 1, viewTop);
+		s32 yEnd = min(FastFloor(yMax - 0.5f) + 1, viewTop + s32(FrameBuffer::GetHeight()));
+
+		for (s32 y = yBegin; y < yEnd; ++y)
+		{
+			f32 yc = f32(y) + 0.5f;
+			f32 xLeft = 0.0f, xRight = 0.0f;
+			bool hit = false;
+			for (u32 i = 0; i < count; ++i)
+			{
+				const AEVec2* a = &pts[i];
+				const AEVec2* b = &pts[(i + 1) % count];
+				if (a->y > b->y)
+					std::swap(a, b);
+				if (!(yc > a->y && yc <= b->y))
+					continue;
+
+				f32 x = a->x + (yc - a->y) * (b->x - a->x) / (b->y - a->y);
+				xLeft = hit ? min(xLeft, x) : x;
+				xRight = hit ? max(xRight, x) : x;
+				hit = true;
+			}
+
+			if (hit)
+				FillSpan(FastFloor(xLeft + 0.5f), FastFloor(xRight + 0.5f), y, pixel);
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Cross
+	/// \brief	z of the cross product of a and b.
+	static f32 Cross(const AEVec2& a, const AEVec2& b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FillJoin
+	/// \brief	Fills the join at p between a segment going along d0 and the
+	///			next one going along d1 (unit vectors). Only the outer side
+	///			needs filling, the inner side is covered by the segments.
+	static void FillJoin(const AEVec2& p, const AEVec2& d0, const AEVec2& d1, const StrokeStyle& style, u32 pixel)
+	{
+		f32 half = style.mWidth * 0.5f;
+		f32 turn = Cross(d0, d1);
+		f32 cosine = d0 * d1;
+
+		//Straight on: nothing sticks out
+		if (fabsf(turn) < 1e-6f && cosine > 0.0f)
+			return;
+
+		if (style.mJoin == eSJ_ROUND)
+		{
+			FillCirclePixel(p, half, pixel);
+			return;
+		}
+
+		//Outer side: right of the path when turning left and vice versa
+		f32 side = turn > 0.0f ? -1.0f : 1.0f;
+		AEVec2 o0 = AEVec2(-d0.y, d0.x) * (half * side);
+		AEVec2 o1 = AEVec2(-d1.y, d1.x) * (half * side);
+
+		//Miter tip along the bisector of the two offsets, as long as the
+		//miter is at most mMiterLimit widths long
+		if (style.mJoin == eSJ_MITER)
+		{
+			AEVec2 bisector = o0 + o1;
+			f32 length = bisector.Length();
+			if (length > 1e-6f)
+			{
+				f32 ratio = 2.0f * half / length;	//miter length / width
+				if (ratio <= style.mMiterLimit)
+				{
+					AEVec2 wedge[cMaxConvexPoints] = { p, p + o0, p + bisector * (half * ratio / length), p + o1 };
+					FillConvex(wedge, 4, pixel);
+					return;
+				}
+			}
+		}
+
+		AEVec2 bevel[3] = { p, p + o0, p + o1 };
+		FillConvex(bevel, 3, pixel);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		StrokePath
+	/// \brief	DrawPolyline once the storage is set up: path and dirs have
+	///			room for count points each.
+	static void StrokePath(const AEVec2* points, u32 count, const StrokeStyle& style, u32 pixel, bool closed, AEVec2* path, AEVec2* dirs)
+	{
+		f32 half = style.mWidth * 0.5f;
+
+		//Drop repeated points, they have no direction
+		u32 n = 0;
+		for (u32 i = 0; i < count; ++i)
+			if (n == 0 || (points[i] - path[n - 1]).LengthSq() > 1e-12f)
+				path[n++] = points[i];
+		if (closed && n > 2 && (path[0] - path[n - 1]).LengthSq() <= 1e-12f)
+			--n;
+		if (n < 3)
+			closed = false;
+
+		//A single point is only visible through its caps
+		if (n == 1)
+		{
+			if (style.mCap == eSC_ROUND)
+				FillCirclePixel(path[0], half, pixel);
+			else if (style.mCap == eSC_SQUARE)
+			{
+				AEVec2 square[4] = { path[0] + AEVec2(-half, -half), path[0] + AEVec2(half, -half),
+					path[0] + AEVec2(half, half), path[0] + AEVec2(-half, half) };
+				FillConvex(square, 4, pixel);
+			}
+			return;
+		}
+
+		//Segment directions
+		u32 segments = closed ? n : n - 1;
+		for (u32 i = 0; i < segments; ++i)
+			dirs[i] = (path[(i + 1) % n] - path[i]).Normalize();
+
+		//1. Segments, square caps stretch the first and last one
+		for (u32 i = 0; i < segments; ++i)
+		{
+			AEVec2 a = path[i];
+			AEVec2 b = path[(i + 1) % n];
+			if (!closed && style.mCap == eSC_SQUARE)
+			{
+				if (i == 0)
+					a -= dirs[i] * half;
+				if (i == segments - 1)
+					b += dirs[i] * half;
+			}
+
+			AEVec2 offset = AEVec2(-dirs[i].y, dirs[i].x) * half;
+			AEVec2 quad[4] = { a + offset, b + offset, b - offset, a - offset };
+			FillConvex(quad, 4, pixel);
+		}
+
+		//2. Joins between consecutive segments
+		for (u32 i = closed ? 0 : 1; i < segments; ++i)
+		{
+			u32 previous = (i + segments - 1) % segments;
+			FillJoin(path[i], dirs[previous], dirs[i], style, pixel);
+		}
+
+		//3. Round caps
+		if (!closed && style.mCap == eSC_ROUND)
+		{
+			FillCirclePixel(path[0], half, pixel);
+			FillCirclePixel(path[n - 1], half, pixel);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DrawThickLine
+	/// \brief	Draws the segment p1 -> p2 with the width and caps of style.
+	void DrawThickLine(const AEVec2& p1, const AEVec2& p2, const StrokeStyle& style, const Color& c)
+	{
+		AEVec2 ends[2] = { p1, p2 };
+		DrawPolyline(ends, 2, style, c, false);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DrawPolyline
+	/// \brief	Strokes the connected lines through points. The points and
+	///			segment directions are kept on the stack for short polylines,
+	///			so there is no allocation per call.
+	void DrawPolyline(const AEVec2* points, u32 count, const StrokeStyle& style, const Color& c, bool closed)
+	{
+		if (!points || count == 0 || !(style.mWidth > 0.0f))
+			return;
+
+		u32 pixel;
+		EncodeColors(&c, 1, reinterpret_cast<u8*>(&pixel));
+
+		AEVec2 stackStorage[2 * cStackStrokePoints];
+		AEVec2* storage = stackStorage;
+		if (count > cStackStrokePoints)
+		{
+			storage = static_cast<AEVec2*>(AlignedPoolAlloc(2 * size_t(count) * sizeof(AEVec2)));
+			if (!storage)
+				return;
+		}
+
+		StrokePath(points, count, style, pixel, closed, storage, storage + count);
+
+		if (storage != stackStorage)
+			AlignedPoolFree(storage);
+	}
+}
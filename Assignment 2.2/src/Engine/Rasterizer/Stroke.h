@@ -0,0 +1,45 @@
+#ifndef CS200_STROKE_H_
+#define CS200_STROKE_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \enum	EStrokeJoin / EStrokeCap
+	/// \brief	How consecutive segments of a stroke are connected and how
+	///			the open ends of a stroke are finished.
+	enum EStrokeJoin { eSJ_MITER, eSJ_ROUND, eSJ_BEVEL };
+	enum EStrokeCap { eSC_BUTT, eSC_SQUARE, eSC_ROUND };
+
+	/// -----------------------------------------------------------------------
+	/// \struct	StrokeStyle
+	/// \brief	Width (in pixels) and shape of a stroke. Miter joins longer
+	///			than mMiterLimit widths (measured from the inner to the outer
+	///			corner) fall back to bevel joins.
+	struct StrokeStyle
+	{
+		StrokeStyle(f32 width = 1.0f, EStrokeJoin join = eSJ_MITER, EStrokeCap cap = eSC_BUTT, f32 miterLimit = 4.0f)
+			: mWidth(width), mJoin(join), mCap(cap), mMiterLimit(miterLimit) {}
+
+		f32			mWidth;
+		EStrokeJoin	mJoin;
+		EStrokeCap	mCap;
+		f32			mMiterLimit;
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DrawThickLine
+	/// \brief	Draws the segment p1 -> p2 with the width and caps of style.
+	void DrawThickLine(const AEVec2& p1, const AEVec2& p2, const StrokeStyle& style, const Color& c);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		DrawPolyline
+	/// \brief	Strokes points[0] -> ... -> points[count - 1], and back to
+	///			points[0] when closed (joins everywhere, no caps). Every
+	///			segment, join and cap is a convex polygon (or a disc for the
+	///			round ones) filled with one solid span per row: the pixels
+	///			whose centers are inside. The color is converted once and the
+	///			pieces only overlap around the joins.
+	void DrawPolyline(const AEVec2* points, u32 count, const StrokeStyle& style, const Color& c, bool closed = false);
+}
+
+#endif
@@ -0,0 +1,206 @@
+// ----------------------------------------------------------------------------
+// File Name		:	Surface.cpp
+// Purpose			:	Rectangle copies, flips and rotations between RGBA
+//						surfaces. Rows are moved with memcpy/memmove and the
+//						rotations transpose cache sized blocks.
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\ParallelFor.h"
+#include <emmintrin.h>
+
+namespace Rasterizer
+{
+	// block size (in pixels) of the rotations, 32 x 32 x 4 = 4KB per block
+	static const u32 cRotateBlock = 32;
+
+	// ------------------------------------------------------------------------
+	/// \fn		ClipRect
+	/// \brief	Clips a w x h rectangle at (x, y) against a surface. Returns
+	///			false if nothing is left.
+	static bool ClipRect(const Surface& s, u32 x, u32 y, u32& w, u32& h)
+	{
+		if (!s.mPixels || x >= s.mWidth || y >= s.mHeight)
+			return false;
+
+		w = min(w, s.mWidth - x);
+		h = min(h, s.mHeight - y);
+		return w != 0 && h != 0;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		Overlaps
+	/// \brief	Whether two rectangles of two surfaces share memory.
+	static bool Overlaps(const Surface& a, u32 ax, u32 ay, u32 aw, u32 ah,
+						 const Surface& b, u32 bx, u32 by, u32 bw, u32 bh)
+	{
+		const u8* aBegin = a.GetPixel(ax, ay);
+		const u8* aEnd = a.GetPixel(ax + aw, ay + ah - 1);
+		const u8* bBegin = b.GetPixel(bx, by);
+		const u8* bEnd = b.GetPixel(bx + bw, by + bh - 1);
+		return aBegin < bEnd && bBegin < aEnd;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		ReversePixels
+	/// \brief	Reverses count pixels in place. Swaps 4 pixels from each end at
+	///			a time while both sides have at least 4 left.
+	static void ReversePixels(u8* pixels, u32 count)
+	{
+		u32* p = reinterpret_cast<u32*>(pixels);
+		u32 i = 0, j = count;
+		for (; i + 8 <= j; i += 4, j -= 4)
+		{
+			__m128i* left = reinterpret_cast<__m128i*>(p + i);
+			__m128i* right = reinterpret_cast<__m128i*>(p + j - 4);
+			__m128i l = _mm_shuffle_epi32(_mm_loadu_si128(left), _MM_SHUFFLE(0, 1, 2, 3));
+			__m128i r = _mm_shuffle_epi32(_mm_loadu_si128(right), _MM_SHUFFLE(0, 1, 2, 3));
+			_mm_storeu_si128(left, r);
+			_mm_storeu_si128(right, l);
+		}
+		for (--j; i < j; ++i, --j)
+		{
+			u32 t = p[i];
+			p[i] = p[j];
+			p[j] = t;
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		RotateBlocks
+	/// \brief	Rotation by 90 or 270 degrees. The source is cut in blocks
+	///			small enough for a source and a destination block to stay in
+	///			L1, so every row read and every row written is reused for the
+	///			whole block. Block rows are split across threads.
+	static void RotateBlocks(const Surface& dst, u32 dx, u32 dy, const Surface& src, u32 sx, u32 sy, u32 w, u32 h, bool clockwise)
+	{
+		u32 blockRows = (h + cRotateBlock - 1) / cRotateBlock;
+		ParallelFor(blockRows, 1, [=](unsigned begin, unsigned end)
+		{
+			for (u32 by = begin * cRotateBlock; by < min(end * cRotateBlock, h); by += cRotateBlock)
+			{
+				u32 bh = min(cRotateBlock, h - by);
+				for (u32 bx = 0; bx < w; bx += cRotateBlock)
+				{
+					u32 bw = min(cRotateBlock, w - bx);
+					for (u32 j = by; j < by + bh; ++j)
+					{
+						const u32* in = reinterpret_cast<const u32*>(src.GetPixel(sx + bx, sy + j));
+
+						// source row j becomes destination column h-1-j (cw) or j (ccw)
+						u32 col = clockwise ? h - 1 - j : j;
+						for (u32 i = 0; i < bw; ++i)
+						{
+							u32 row = clockwise ? bx + i : w - 1 - (bx + i);
+							*reinterpret_cast<u32*>(dst.GetPixel(dx + col, dy + row)) = in[i];
+						}
+					}
+				}
+			}
+		});
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Blit
+	/// \brief	Copies a rectangle between (or within) surfaces, overlap safe.
+	void Blit(const Surface& dst, u32 dx, u32 dy, const Surface& src, u32 sx, u32 sy, u32 w, u32 h)
+	{
+		if (!ClipRect(src, sx, sy, w, h) || !ClipRect(dst, dx, dy, w, h))
+			return;
+
+		u32 rowBytes = w * 4;
+
+		// copying downwards over the source: go bottom up so the rows still
+		// to be read are not overwritten. memmove takes care of each row.
+		if (dst.GetPixel(dx, dy) > src.GetPixel(sx, sy))
+		{
+			for (u32 j = h; j-- > 0;)
+				memmove(dst.GetPixel(dx, dy + j), src.GetPixel(sx, sy + j), rowBytes);
+		}
+		else
+		{
+			for (u32 j = 0; j < h; ++j)
+				memmove(dst.GetPixel(dx, dy + j), src.GetPixel(sx, sy + j), rowBytes);
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FlipHorizontal
+	/// \brief	Mirrors the rectangle left to right, in place.
+	void FlipHorizontal(const Surface& s, u32 x, u32 y, u32 w, u32 h)
+	{
+		if (!ClipRect(s, x, y, w, h))
+			return;
+
+		for (u32 j = 0; j < h; ++j)
+			ReversePixels(s.GetPixel(x, y + j), w);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FlipVertical
+	/// \brief	Mirrors the rectangle top to bottom, in place. Rows are swapped
+	///			through a small stack buffer.
+	void FlipVertical(const Surface& s, u32 x, u32 y, u32 w, u32 h)
+	{
+		if (!ClipRect(s, x, y, w, h))
+			return;
+
+		u8 chunk[1024];
+		u32 rowBytes = w * 4;
+		for (u32 top = 0, bottom = h - 1; top < bottom; ++top, --bottom)
+		{
+			u8* a = s.GetPixel(x, y + top);
+			u8* b = s.GetPixel(x, y + bottom);
+			for (u32 offset = 0; offset < rowBytes; offset += sizeof(chunk))
+			{
+				u32 size = min(u32(sizeof(chunk)), rowBytes - offset);
+				memcpy(chunk, a + offset, size);
+				memcpy(a + offset, b + offset, size);
+				memcpy(b + offset, chunk, size);
+			}
+		}
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Rotate
+	/// \brief	Writes the rectangle rotated clockwise to dst.
+	void Rotate(const Surface& dst, u32 dx, u32 dy, const Surface& src, u32 sx, u32 sy, u32 w, u32 h, ERotation rotation)
+	{
+		if (!ClipRect(src, sx, sy, w, h))
+			return;
+
+		// rotated size, clipped against the destination
+		bool quarter = rotation != eROT_180;
+		u32 rw = quarter ? h : w;
+		u32 rh = quarter ? w : h;
+		u32 cw = rw, ch = rh;
+		if (!ClipRect(dst, dx, dy, cw, ch))
+			return;
+
+		// rotate into scratch memory when the result is clipped or would
+		// overwrite pixels that are still to be read
+		if (cw != rw || ch != rh || Overlaps(dst, dx, dy, rw, rh, src, sx, sy, w, h))
+		{
+			std::vector<u8> scratch(rw * rh * 4);
+			Surface temp(scratch.data(), rw, rh);
+			Rotate(temp, 0, 0, src, sx, sy, w, h, rotation);
+			Blit(dst, dx, dy, temp, 0, 0, cw, ch);
+			return;
+		}
+
+		if (quarter)
+		{
+			RotateBlocks(dst, dx, dy, src, sx, sy, w, h, rotation == eROT_90);
+			return;
+		}
+
+		// 180: every row is copied reversed to the mirrored row
+		for (u32 j = 0; j < h; ++j)
+		{
+			u8* row = dst.GetPixel(dx, dy + h - 1 - j);
+			memcpy(row, src.GetPixel(sx, sy + j), w * 4);
+			ReversePixels(row, w);
+		}
+	}
+}
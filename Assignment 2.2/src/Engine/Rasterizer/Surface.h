@@ -0,0 +1,66 @@
+#ifndef CS200_SURFACE_H_
+#define CS200_SURFACE_H_
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \struct	Surface
+	/// \brief	Non owning view of an RGBA pixel rectangle: the frame buffer,
+	///			a loaded image, a sub-rectangle of either or any scratch
+	///			buffer. Rows are mPitch bytes apart (at least mWidth * 4).
+	struct Surface
+	{
+		Surface() : mPixels(NULL), mWidth(0), mHeight(0), mPitch(0) {}
+		Surface(u8* pixels, u32 width, u32 height, u32 pitch = 0)
+			: mPixels(pixels), mWidth(width), mHeight(height), mPitch(pitch ? pitch : width * 4) {}
+
+		u8*		GetRow(u32 y) const { return mPixels + size_t(y) * mPitch; }
+		u8*		GetPixel(u32 x, u32 y) const { return mPixels + size_t(y) * mPitch + x * 4; }
+
+		// Rectangle of this surface (clipped to it) with its own origin.
+		// Shares the pixels and the pitch.
+		Surface	SubView(u32 x, u32 y, u32 width, u32 height) const
+		{
+			if (x >= mWidth || y >= mHeight)
+				return Surface(NULL, 0, 0, mPitch);
+			return Surface(GetPixel(x, y), min(width, mWidth - x), min(height, mHeight - y), mPitch);
+		}
+
+		u8*		mPixels;
+		u32		mWidth;
+		u32		mHeight;
+		u32		mPitch;		// bytes between rows
+	};
+
+	/// -----------------------------------------------------------------------
+	/// \enum	ERotation
+	/// \brief	Clockwise rotations supported by Rotate.
+	enum ERotation { eROT_90, eROT_180, eROT_270 };
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Blit
+	/// \brief	Copies the w x h rectangle at (sx, sy) of src to (dx, dy) of
+	///			dst. Both rectangles are clipped. src and dst may be the same
+	///			surface and the rectangles may overlap.
+	void Blit(const Surface& dst, u32 dx, u32 dy, const Surface& src, u32 sx, u32 sy, u32 w, u32 h);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FlipHorizontal
+	/// \brief	Mirrors the rectangle left to right, in place.
+	void FlipHorizontal(const Surface& s, u32 x, u32 y, u32 w, u32 h);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		FlipVertical
+	/// \brief	Mirrors the rectangle top to bottom, in place.
+	void FlipVertical(const Surface& s, u32 x, u32 y, u32 w, u32 h);
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Rotate
+	/// \brief	Writes the w x h rectangle at (sx, sy) of src rotated clockwise
+	///			to (dx, dy) of dst. For 90 and 270 degrees the result is h x w.
+	///			The source is clipped to src and the result to dst. Overlapping
+	///			rectangles are handled through a temporary copy.
+	void Rotate(const Surface& dst, u32 dx, u32 dy, const Surface& src, u32 sx, u32 sy, u32 w, u32 h, ERotation rotation);
+}
+
+#endif
@@ -0,0 +1,328 @@
+// ----------------------------------------------------------------------------
+// File Name		:	TiledRenderTarget.cpp
+// Purpose			:	Out of core offscreen rendering. Tiles live in memory
+//						(aligned pool blocks) while in use and in a backing
+//						file otherwise, at offset index * tile bytes (64 bit).
+// ----------------------------------------------------------------------------
+
+#include <AEEngine.h>
+#include "Rasterizer.h"
+#include "..\Utils\AlignedPool.h"
+
+namespace Rasterizer
+{
+	// bytes per tile
+	static const u32 cTileBytes = TiledRenderTarget::cTileSize * TiledRenderTarget::cTileSize * 4;
+
+	// ------------------------------------------------------------------------
+	/// \fn		TiledRenderTarget
+	/// \brief	Empty target, call Create.
+	TiledRenderTarget::TiledRenderTarget()
+		: mWidth(0), mHeight(0), mTilesX(0), mTilesY(0), mMaxResident(0), mResident(0)
+	{
+		memset(mClearColor, 0, sizeof(mClearColor));
+	}
+
+	TiledRenderTarget::~TiledRenderTarget()
+	{
+		Destroy();
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Create
+	/// \brief	Sets up a width x height target. No pixel memory is allocated
+	///			yet. backingFile is created (or truncated) and grows as tiles
+	///			are evicted. Returns false if it cannot be opened.
+	bool TiledRenderTarget::Create(u32 width, u32 height, const char* backingFile, u32 maxResidentTiles)
+	{
+		Destroy();
+		if (!backingFile || width == 0 || height == 0)
+			return false;
+
+		mBacking.open(backingFile, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!mBacking.is_open())
+			return false;
+
+		mWidth = width;
+		mHeight = height;
+		mTilesX = (width + cTileSize - 1) / cTileSize;
+		mTilesY = (height + cTileSize - 1) / cTileSize;
+		mMaxResident = max(1u, maxResidentTiles);
+		mTiles.resize(size_t(mTilesX) * mTilesY);
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Destroy
+	/// \brief	Frees every tile and closes the backing file.
+	void TiledRenderTarget::Destroy()
+	{
+		for (size_t i = 0; i < mTiles.size(); ++i)
+			AlignedPoolFree(mTiles[i].mPixels);
+		mTiles.clear();
+		mLru.clear();
+		if (mBacking.is_open())
+			mBacking.close();
+
+		mWidth = mHeight = mTilesX = mTilesY = mResident = 0;
+	}
+
+	// ------------------------------------------------------------------------
+	// Getters
+	u32 TiledRenderTarget::GetWidth() const
+	{
+		return mWidth;
+	}
+	u32 TiledRenderTarget::GetHeight() const
+	{
+		return mHeight;
+	}
+	u32 TiledRenderTarget::GetResidentTileCount() const
+	{
+		return mResident;
+	}
+	u32 TiledRenderTarget::GetAllocatedTileCount() const
+	{
+		u32 count = 0;
+		for (size_t i = 0; i < mTiles.size(); ++i)
+			count += mTiles[i].mState != eTS_EMPTY;
+		return count;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Clear
+	/// \brief	Drops every tile, the whole target reads as the given color.
+	void TiledRenderTarget::Clear(u8 r, u8 g, u8 b, u8 a)
+	{
+		mClearColor[0] = r;
+		mClearColor[1] = g;
+		mClearColor[2] = b;
+		mClearColor[3] = a;
+
+		for (size_t i = 0; i < mTiles.size(); ++i)
+		{
+			AlignedPoolFree(mTiles[i].mPixels);
+			mTiles[i] = Tile();
+		}
+		mLru.clear();
+		mResident = 0;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Render
+	/// \brief	Runs the callback on every tile.
+	bool TiledRenderTarget::Render(const DrawCallback& draw)
+	{
+		return Render(draw, 0, 0, mWidth, mHeight);
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		Render
+	/// \brief	Runs the callback on every tile that overlaps the rectangle
+	///			(what the callback draws outside of it may be lost). The frame
+	///			buffer binding is restored afterwards. Returns false if some
+	///			tile could not be made resident (out of memory, or the backing
+	///			file failed), those tiles are not drawn.
+	bool TiledRenderTarget::Render(const DrawCallback& draw, u32 x, u32 y, u32 w, u32 h)
+	{
+		if (!draw || x >= mWidth || y >= mHeight || w == 0 || h == 0)
+			return false;
+
+		w = min(w, mWidth - x);
+		h = min(h, mHeight - y);
+
+		bool drawn = true;
+		Surface previous = FrameBuffer::GetSurface();
+		u32 previousX = FrameBuffer::GetOriginX();
+		u32 previousY = FrameBuffer::GetOriginY();
+
+		for (u32 ty = y / cTileSize; ty <= (y + h - 1) / cTileSize; ++ty)
+		{
+			for (u32 tx = x / cTileSize; tx <= (x + w - 1) / cTileSize; ++tx)
+			{
+				u32 index = ty * mTilesX + tx;
+				if (!AcquireTile(index))
+				{
+					drawn = false;
+					continue;
+				}
+
+				mTiles[index].mDirty = true;
+				FrameBuffer::Bind(GetTileSurface(index), tx * cTileSize, ty * cTileSize);
+				draw();
+			}
+		}
+
+		FrameBuffer::Bind(previous, previousX, previousY);
+		return drawn;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		ReadRegion
+	/// \brief	Copies a rectangle (fully inside the target) to out, as w * h
+	///			tightly packed RGBA pixels.
+	bool TiledRenderTarget::ReadRegion(u32 x, u32 y, u32 w, u32 h, u8* out)
+	{
+		if (!out || w == 0 || h == 0 || x >= mWidth || y >= mHeight || w > mWidth - x || h > mHeight - y)
+			return false;
+
+		Surface dst(out, w, h);
+		for (u32 ty = y / cTileSize; ty <= (y + h - 1) / cTileSize; ++ty)
+		{
+			for (u32 tx = x / cTileSize; tx <= (x + w - 1) / cTileSize; ++tx)
+			{
+				// overlap of the tile and the rectangle, in target coordinates
+				u32 x0 = max(x, tx * cTileSize), x1 = min(x + w, (tx + 1) * cTileSize);
+				u32 y0 = max(y, ty * cTileSize), y1 = min(y + h, (ty + 1) * cTileSize);
+
+				// never drawn on: clear color, no need to allocate the tile
+				u32 index = ty * mTilesX + tx;
+				if (mTiles[index].mState == eTS_EMPTY)
+				{
+					for (u32 row = y0; row < y1; ++row)
+						FillPixels(dst.GetPixel(x0 - x, row - y), x1 - x0);
+					continue;
+				}
+
+				if (!AcquireTile(index))
+					return false;
+				Blit(dst, x0 - x, y0 - y, GetTileSurface(index), x0 - tx * cTileSize, y0 - ty * cTileSize, x1 - x0, y1 - y0);
+			}
+		}
+		return true;
+	}
+
+	/// -----------------------------------------------------------------------
+	/// \fn		SaveToFile
+	/// \brief	Same format as FrameBuffer::SaveToFile (width, height, RGBA
+	///			rows), written one band of tiles at a time.
+	bool TiledRenderTarget::SaveToFile(const char* filename)
+	{
+		if (!filename || mTiles.empty())
+			return false;
+
+		std::fstream fp(filename, std::ios::out | std::ios::binary);
+		if (!fp.is_open() || !fp.good())
+			return false;
+
+		fp.write(reinterpret_cast<const char*>(&mWidth), sizeof(u32));
+		fp.write(reinterpret_cast<const char*>(&mHeight), sizeof(u32));
+
+		std::vector<u8> band(size_t(mWidth) * cTileSize * 4);
+		for (u32 ty = 0; ty < mTilesY; ++ty)
+		{
+			u32 y = ty * cTileSize;
+			u32 rows = min(cTileSize, mHeight - y);
+			if (!ReadRegion(0, y, mWidth, rows, band.data()))
+				return false;
+			fp.write(reinterpret_cast<const char*>(band.data()), std::streamsize(size_t(mWidth) * rows * 4));
+		}
+		return fp.good();
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetTileSurface
+	/// \brief	Resident tile as a surface, clipped to the target size.
+	Surface TiledRenderTarget::GetTileSurface(u32 index)
+	{
+		u32 tx = index % mTilesX;
+		u32 ty = index / mTilesX;
+		Surface tile(mTiles[index].mPixels, cTileSize, cTileSize);
+		return tile.SubView(0, 0, mWidth - tx * cTileSize, mHeight - ty * cTileSize);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		AcquireTile
+	/// \brief	Makes a tile resident and most recently used. Empty tiles are
+	///			filled with the clear color, evicted ones are read back. Evicts
+	///			the least recently used tile when over budget. Returns NULL
+	///			when memory runs out, the tile cannot be read back or the
+	///			tile to evict cannot be written.
+	u8* TiledRenderTarget::AcquireTile(u32 index)
+	{
+		Tile& tile = mTiles[index];
+		if (tile.mState == eTS_RESIDENT)
+		{
+			mLru.splice(mLru.begin(), mLru, tile.mLru);
+			return tile.mPixels;
+		}
+
+		if (mResident >= mMaxResident && !EvictTile(mLru.back()))
+			return NULL;
+
+		u8* pixels = static_cast<u8*>(AlignedPoolAlloc(cTileBytes));
+		if (!pixels)
+			return NULL;
+
+		if (tile.mState == eTS_ON_DISK)
+		{
+			mBacking.clear();
+			mBacking.seekg(std::streamoff(u64(index) * cTileBytes));
+			mBacking.read(reinterpret_cast<char*>(pixels), cTileBytes);
+
+			// short or failed read, the tile stays on disk
+			if (mBacking.fail() || u32(mBacking.gcount()) != cTileBytes)
+			{
+				mBacking.clear();
+				AlignedPoolFree(pixels);
+				return NULL;
+			}
+		}
+		else
+			FillPixels(pixels, cTileSize * cTileSize);
+
+		tile.mPixels = pixels;
+		tile.mState = eTS_RESIDENT;
+		tile.mDirty = false;
+		mLru.push_front(index);
+		tile.mLru = mLru.begin();
+		++mResident;
+		return pixels;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		EvictTile
+	/// \brief	Writes the tile to the backing file (unless the copy there is
+	///			up to date) and frees its memory. If the write fails (e.g. the
+	///			disk is full) the tile stays resident and dirty and false is
+	///			returned.
+	bool TiledRenderTarget::EvictTile(u32 index)
+	{
+		Tile& tile = mTiles[index];
+		if (tile.mDirty || !tile.mStored)
+		{
+			mBacking.clear();
+			mBacking.seekp(std::streamoff(u64(index) * cTileBytes));
+			mBacking.write(reinterpret_cast<const char*>(tile.mPixels), cTileBytes);
+			mBacking.flush();
+			if (mBacking.fail())
+			{
+				// the copy on disk may be partly overwritten
+				mBacking.clear();
+				tile.mStored = false;
+				tile.mDirty = true;
+				return false;
+			}
+			tile.mStored = true;
+		}
+
+		AlignedPoolFree(tile.mPixels);
+		tile.mPixels = NULL;
+		tile.mState = eTS_ON_DISK;
+		tile.mDirty = false;
+		mLru.erase(tile.mLru);
+		--mResident;
+		return true;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		FillPixels
+	/// \brief	Sets count pixels to the clear color, doubling the copies.
+	void TiledRenderTarget::FillPixels(u8* pixels, u32 count)
+	{
+		u32 bytes = count * 4;
+		memcpy(pixels, mClearColor, 4);
+		for (u32 filled = 4; filled < bytes; filled *= 2)
+			memcpy(pixels + filled, pixels, min(filled, bytes - filled));
+	}
+}
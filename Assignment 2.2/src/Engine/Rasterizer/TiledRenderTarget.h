@@ -0,0 +1,87 @@
+#ifndef CS200_TILED_RENDER_TARGET_H_
+#define CS200_TILED_RENDER_TARGET_H_
+
+#include <fstream>
+#include <functional>
+#include <list>
+#include <vector>
+
+namespace Rasterizer
+{
+	/// -----------------------------------------------------------------------
+	/// \class	TiledRenderTarget
+	/// \brief	Offscreen target far bigger than what fits in memory (e.g. a
+	///			32k x 32k poster). The image is cut in cTileSize square tiles
+	///			that are only allocated once something draws on them. At most
+	///			maxResidentTiles are kept in memory, the least recently used
+	///			ones are written to a backing file and read back on demand.
+	///
+	///			Render runs a draw callback once per tile with the tile bound
+	///			as the frame buffer view (origin at the tile position), so the
+	///			usual Draw* calls in target coordinates just work. Pass the
+	///			bounds of what the callback draws to skip the other tiles.
+	class TiledRenderTarget
+	{
+	public:
+		typedef std::function<void()> DrawCallback;
+
+		// tile width and height in pixels (256KB per tile)
+		static const u32 cTileSize = 256;
+
+		TiledRenderTarget();
+		~TiledRenderTarget();
+
+		// Initialize
+		bool	Create(u32 width, u32 height, const char* backingFile, u32 maxResidentTiles = 256);
+		void	Destroy();
+
+		// Getters
+		u32		GetWidth() const;
+		u32		GetHeight() const;
+		u32		GetResidentTileCount() const;
+		u32		GetAllocatedTileCount() const;
+
+		// Operations
+		void	Clear(u8 r, u8 g, u8 b, u8 a = 255);
+		bool	Render(const DrawCallback& draw);
+		bool	Render(const DrawCallback& draw, u32 x, u32 y, u32 w, u32 h);
+		bool	ReadRegion(u32 x, u32 y, u32 w, u32 h, u8* out);
+		bool	SaveToFile(const char* filename);
+
+	private:
+		enum ETileState { eTS_EMPTY, eTS_RESIDENT, eTS_ON_DISK };
+
+		struct Tile
+		{
+			Tile() : mPixels(NULL), mState(eTS_EMPTY), mDirty(false), mStored(false) {}
+
+			u8*							mPixels;	// cTileSize x cTileSize RGBA, when resident
+			ETileState					mState;
+			bool						mDirty;		// changed since last written
+			bool						mStored;	// has a copy in the backing file
+			std::list<u32>::iterator	mLru;
+		};
+
+		Surface	GetTileSurface(u32 index);
+		u8*		AcquireTile(u32 index);
+		bool	EvictTile(u32 index);
+		void	FillPixels(u8* pixels, u32 count);
+
+		// no copies
+		TiledRenderTarget(const TiledRenderTarget&);
+		TiledRenderTarget& operator=(const TiledRenderTarget&);
+
+		u32					mWidth;
+		u32					mHeight;
+		u32					mTilesX;
+		u32					mTilesY;
+		u32					mMaxResident;
+		u32					mResident;
+		u8					mClearColor[4];
+		std::vector<Tile>	mTiles;
+		std::list<u32>		mLru;		// resident tiles, most recently used first
+		std::fstream		mBacking;
+	};
+}
+
+#endif
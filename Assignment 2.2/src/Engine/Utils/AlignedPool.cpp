@@ -0,0 +1,237 @@
+#include "AlignedPool.h"
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#include <sys/mman.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// HELPERS
+
+namespace
+{
+	// smallest size class
+	const size_t cMinClassSize = 64 * 1024;
+
+	// blocks cached per size class
+	const size_t cMaxCachedPerClass = 2;
+
+	// ------------------------------------------------------------------------
+	/// \struct	BlockHeader
+	/// \brief	Stored in the cPoolAlignment bytes in front of every block.
+	struct BlockHeader
+	{
+		void*	mBase;			// what the system returned
+		size_t	mCapacity;		// usable bytes after the header
+		bool	mLargePages;
+	};
+
+	static_assert(sizeof(BlockHeader) <= cPoolAlignment, "block header does not fit in the alignment");
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetHeader
+	/// \brief	Header of a block returned by AlignedPoolAlloc.
+	BlockHeader* GetHeader(const void* block)
+	{
+		return reinterpret_cast<BlockHeader*>(const_cast<char*>(static_cast<const char*>(block)) - cPoolAlignment);
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetSizeClass
+	/// \brief	Size classes are 4 steps per power of two (1, 1.25, 1.5, 1.75
+	///			times 2^n), so at most 25% of a block is wasted.
+	size_t GetSizeClass(size_t size)
+	{
+		if (size <= cMinClassSize)
+			return cMinClassSize;
+
+		size_t power = cMinClassSize;
+		while (power * 2 < size)
+			power *= 2;
+
+		size_t step = power / 4;
+		return (size + step - 1) / step * step;
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		GetLargePageSize
+	/// \brief	Large page size of the system, 0 if unsupported.
+	size_t GetLargePageSize()
+	{
+#ifdef _WIN32
+		return GetLargePageMinimum();
+#else
+		return 2 * 1024 * 1024;
+#endif
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		SystemAlloc
+	/// \brief	Allocates header + capacity bytes, aligned. Tries large pages
+	///			first when asked to.
+	void* SystemAlloc(size_t bytes, bool largePages, bool& gotLargePages)
+	{
+		gotLargePages = false;
+#ifdef _WIN32
+		if (largePages)
+		{
+			// needs the "lock pages in memory" privilege, fails otherwise
+			size_t page = GetLargePageSize();
+			void* p = VirtualAlloc(NULL, (bytes + page - 1) / page * page,
+				MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (p)
+			{
+				gotLargePages = true;
+				return p;
+			}
+		}
+		return _aligned_malloc(bytes, cPoolAlignment);
+#else
+		void* p = NULL;
+		size_t alignment = largePages ? GetLargePageSize() : cPoolAlignment;
+		if (posix_memalign(&p, alignment, bytes) != 0)
+			return NULL;
+		if (largePages)
+			madvise(p, bytes, MADV_HUGEPAGE);
+		return p;
+#endif
+	}
+
+	// ------------------------------------------------------------------------
+	/// \fn		SystemFree
+	/// \brief	Inverse of SystemAlloc.
+	void SystemFree(void* base, bool largePages)
+	{
+#ifdef _WIN32
+		if (largePages)
+			VirtualFree(base, 0, MEM_RELEASE);
+		else
+			_aligned_free(base);
+#else
+		(void)largePages;
+		free(base);
+#endif
+	}
+
+	// ------------------------------------------------------------------------
+	/// \class	AlignedPool
+	/// \brief	Free blocks, grouped by capacity.
+	class AlignedPool
+	{
+	public:
+		AlignedPool() : mLargePages(false) {}
+		~AlignedPool() { Trim(); }
+
+		void* Alloc(size_t size)
+		{
+			size_t capacity = GetSizeClass(size);
+			bool largePages;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				for (size_t i = 0; i < mFree.size(); ++i)
+				{
+					if (GetHeader(mFree[i])->mCapacity == capacity)
+					{
+						void* block = mFree[i];
+						mFree.erase(mFree.begin() + i);
+						return block;
+					}
+				}
+				largePages = mLargePages && capacity >= GetLargePageSize() && GetLargePageSize() != 0;
+			}
+
+			bool gotLargePages;
+			void* base = SystemAlloc(capacity + cPoolAlignment, largePages, gotLargePages);
+			if (!base)
+				return NULL;
+
+			void* block = static_cast<char*>(base) + cPoolAlignment;
+			BlockHeader* header = GetHeader(block);
+			header->mBase = base;
+			header->mCapacity = capacity;
+			header->mLargePages = gotLargePages;
+			return block;
+		}
+
+		void Free(void* block)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				size_t capacity = GetHeader(block)->mCapacity;
+				size_t cached = 0;
+				for (size_t i = 0; i < mFree.size(); ++i)
+					cached += GetHeader(mFree[i])->mCapacity == capacity;
+				if (cached < cMaxCachedPerClass)
+				{
+					mFree.push_back(block);
+					return;
+				}
+			}
+			Release(block);
+		}
+
+		void SetLargePages(bool enabled)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mLargePages = enabled;
+		}
+
+		void Trim()
+		{
+			std::vector<void*> blocks;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				blocks.swap(mFree);
+			}
+			for (size_t i = 0; i < blocks.size(); ++i)
+				Release(blocks[i]);
+		}
+
+	private:
+		static void Release(void* block)
+		{
+			BlockHeader* header = GetHeader(block);
+			SystemFree(header->mBase, header->mLargePages);
+		}
+
+		std::mutex			mMutex;
+		std::vector<void*>	mFree;
+		bool				mLargePages;
+	};
+
+	AlignedPool sPool;
+}
+
+// ----------------------------------------------------------------------------
+// AlignedPool
+
+void* AlignedPoolAlloc(size_t size)
+{
+	return sPool.Alloc(size);
+}
+
+void AlignedPoolFree(void* block)
+{
+	if (block)
+		sPool.Free(block);
+}
+
+size_t AlignedPoolGetCapacity(const void* block)
+{
+	return block ? GetHeader(block)->mCapacity : 0;
+}
+
+void AlignedPoolSetLargePages(bool enabled)
+{
+	sPool.SetLargePages(enabled);
+}
+
+void AlignedPoolTrim()
+{
+	sPool.Trim();
+}
@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+//
+//	\file	AlignedPool.h
+//	\brief	Cache line aligned allocations for pixel buffers, recycled through
+//			a size class pool so buffers of similar size do not go back to
+//			the system allocator.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef ALIGNED_POOL_H_
+#define ALIGNED_POOL_H_
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+/// \brief	Alignment of every block returned by AlignedPoolAlloc.
+const size_t cPoolAlignment = 64;
+
+// ----------------------------------------------------------------------------
+/// \fn		AlignedPoolAlloc
+/// \brief	Returns a cPoolAlignment aligned block of at least size bytes, or
+///			NULL. The size is rounded up to its size class, a cached block of
+///			that class is reused when available.
+void* AlignedPoolAlloc(size_t size);
+
+// ----------------------------------------------------------------------------
+/// \fn		AlignedPoolFree
+/// \brief	Returns a block to the pool. A few blocks per size class are kept
+///			for later allocations, the rest are released. NULL is ignored.
+void AlignedPoolFree(void* block);
+
+// ----------------------------------------------------------------------------
+/// \fn		AlignedPoolGetCapacity
+/// \brief	Usable size of a block (its size class), 0 for NULL.
+size_t AlignedPoolGetCapacity(const void* block);
+
+// ----------------------------------------------------------------------------
+/// \fn		AlignedPoolSetLargePages
+/// \brief	When enabled, blocks of at least one large page are requested as
+///			large pages (falls back to normal pages if the system refuses).
+void AlignedPoolSetLargePages(bool enabled);
+
+// ----------------------------------------------------------------------------
+/// \fn		AlignedPoolTrim
+/// \brief	Releases every cached block. Safe to call more than once.
+void AlignedPoolTrim();
+
+// ----------------------------------------------------------------------------
+#endif
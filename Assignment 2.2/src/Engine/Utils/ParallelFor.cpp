@@ -0,0 +1,184 @@
+#include "ParallelFor.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// HELPERS
+
+namespace
+{
+	// ------------------------------------------------------------------------
+	/// \class	WorkerPool
+	/// \brief	Workers sleep on mWake until a new job id is published, grab
+	///			batches from mNextBatch until none are left and report back
+	///			through mDone.
+	class WorkerPool
+	{
+	public:
+		WorkerPool() : mTask(nullptr), mCount(0), mBatchSize(1), mBatchCount(0),
+			mNextBatch(0), mPending(0), mJobId(0), mQuit(false), mBusy(false), mStarted(false)
+		{}
+		~WorkerPool() { Shutdown(); }
+
+		unsigned GetThreadCount()
+		{
+			Start();
+			return (unsigned)mThreads.size() + 1;
+		}
+
+		void Run(unsigned count, unsigned minBatch, const ParallelTask& task)
+		{
+			if (minBatch == 0)
+				minBatch = 1;
+
+			// small jobs, nested calls or a job already in flight: run here
+			unsigned threads = GetThreadCount();
+			if (sInsideTask || threads == 1 || count <= minBatch || mBusy.exchange(true))
+			{
+				task(0, count);
+				return;
+			}
+
+			// a few batches per thread so uneven rows still balance out
+			unsigned batchSize = count / (threads * 4);
+			if (batchSize < minBatch)
+				batchSize = minBatch;
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mTask = &task;
+				mCount = count;
+				mBatchSize = batchSize;
+				mBatchCount = (count + batchSize - 1) / batchSize;
+				mNextBatch = 0;
+				mPending = (unsigned)mThreads.size();
+				++mJobId;
+			}
+			mWake.notify_all();
+
+			// the calling thread works as well
+			DoBatches();
+
+			// wait for the workers to drain
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mDone.wait(lock, [this]() { return mPending == 0; });
+				mTask = nullptr;
+			}
+			mBusy = false;
+		}
+
+		void Shutdown()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (!mStarted || mQuit)
+					return;
+				mQuit = true;
+			}
+			mWake.notify_all();
+			for (auto& t : mThreads)
+				if (t.joinable())
+					t.join();
+			mThreads.clear();
+		}
+
+	private:
+		void Start()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mStarted)
+				return;
+			mStarted = true;
+
+			unsigned hw = std::thread::hardware_concurrency();
+			for (unsigned i = 1; i < hw; ++i)
+				mThreads.emplace_back(&WorkerPool::WorkerLoop, this);
+		}
+
+		void DoBatches()
+		{
+			sInsideTask = true;
+			for (;;)
+			{
+				unsigned b = mNextBatch.fetch_add(1);
+				if (b >= mBatchCount)
+					break;
+				unsigned begin = b * mBatchSize;
+				unsigned end = begin + mBatchSize;
+				if (end > mCount)
+					end = mCount;
+				(*mTask)(begin, end);
+			}
+			sInsideTask = false;
+		}
+
+		void WorkerLoop()
+		{
+			unsigned long long seenJob = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mWake.wait(lock, [&]() { return mQuit || mJobId != seenJob; });
+					if (mQuit)
+						return;
+					seenJob = mJobId;
+				}
+
+				DoBatches();
+
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					--mPending;
+				}
+				mDone.notify_one();
+			}
+		}
+
+		std::vector<std::thread>	mThreads;
+		std::mutex					mMutex;
+		std::condition_variable		mWake;
+		std::condition_variable		mDone;
+
+		const ParallelTask*			mTask;
+		unsigned					mCount;
+		unsigned					mBatchSize;
+		unsigned					mBatchCount;
+		std::atomic<unsigned>		mNextBatch;
+		unsigned					mPending;
+		unsigned long long			mJobId;
+		bool						mQuit;
+		std::atomic<bool>			mBusy;
+		bool						mStarted;
+
+		static thread_local bool	sInsideTask;
+	};
+
+	thread_local bool WorkerPool::sInsideTask = false;
+
+	WorkerPool sPool;
+}
+
+// ----------------------------------------------------------------------------
+// ParallelFor
+
+void ParallelFor(unsigned count, unsigned minBatch, const ParallelTask& task)
+{
+	if (count == 0)
+		return;
+	sPool.Run(count, minBatch, task);
+}
+
+unsigned ParallelGetThreadCount()
+{
+	return sPool.GetThreadCount();
+}
+
+void ParallelShutdown()
+{
+	sPool.Shutdown();
+}
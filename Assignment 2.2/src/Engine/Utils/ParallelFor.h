@@ -0,0 +1,37 @@
+// ----------------------------------------------------------------------------
+//
+//	\file	ParallelFor.h
+//	\brief	Small persistent worker pool used to split per-row frame buffer
+//			work across the available cores.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef PARALLEL_FOR_H_
+#define PARALLEL_FOR_H_
+
+#include <functional>
+
+// ----------------------------------------------------------------------------
+/// \brief	Task signature. Processes the half open range [begin, end).
+typedef std::function<void(unsigned begin, unsigned end)> ParallelTask;
+
+// ----------------------------------------------------------------------------
+/// \fn		ParallelFor
+/// \brief	Splits [0, count) in batches of at least minBatch elements and runs
+///			the task on the worker pool (the calling thread helps too).
+///			Returns once every batch is done. Runs serially when the range is
+///			too small to be worth it or when called from inside a task.
+void ParallelFor(unsigned count, unsigned minBatch, const ParallelTask& task);
+
+// ----------------------------------------------------------------------------
+/// \fn		ParallelGetThreadCount
+/// \brief	Number of threads (workers + caller) that ParallelFor can use.
+unsigned ParallelGetThreadCount();
+
+// ----------------------------------------------------------------------------
+/// \fn		ParallelShutdown
+/// \brief	Joins the worker threads. Safe to call more than once.
+void ParallelShutdown();
+
+// ----------------------------------------------------------------------------
+#endif
@@ -31,6 +31,9 @@ bool ShowFrameworkMenu(MenuFn demoMenu)
 		DrawLineMethods[Rasterizer::eDL_NAIVE] = "Explicit Line Equation";
 		DrawLineMethods[Rasterizer::eDL_BRESENHAM] = "Bresenham ";
 		DrawLineMethods[Rasterizer::eDL_DDA] = "DDA";
+		DrawLineMethods[Rasterizer::eDL_RUN_SLICE] = "Run Slice";
+		DrawLineMethods[Rasterizer::eDL_DOUBLE_STEP] = "Double Step";
+		DrawLineMethods[Rasterizer::eDL_WU] = "Xiaolin Wu (Anti-aliased)";
 
 		RoundingMethods[Rasterizer::eRM_TRUNCATE] = "Truncate";
 		RoundingMethods[Rasterizer::eRM_TRUNCATE_SHIFT] = "Truncate Shift";
@@ -194,6 +197,10 @@ bool ShowFrameworkMenu(MenuFn demoMenu)
 
 				ImGui::EndMenu();
 			}
+			// color space
+			bool linear = Rasterizer::GetColorSpace() == Rasterizer::eCS_SRGB;
+			if (ImGui::MenuItem("Linear Color (sRGB)", 0, &linear))
+				Rasterizer::SetColorSpace(linear ? Rasterizer::eCS_SRGB : Rasterizer::eCS_GAMMA);
 			// resolution. 
 			if (ImGui::BeginMenu("Resolution")) {
 				static const char* resNames[] = {"640x480", "800x600", "1280x720", "1600x900" };
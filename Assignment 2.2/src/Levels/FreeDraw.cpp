@@ -13,6 +13,7 @@
 #include "Common.h"
 #include "GameStates.h"
 #include <imgui/imgui.h>
+#include <deque>
 
 namespace FreeDraw {
 	// ----------------------------------------------------------------------------
@@ -25,8 +26,45 @@ namespace FreeDraw {
 	enum EFreeDrawPrimitive { eFD_LINES, eFD_CIRCLES, eFD_ELLIPSES, eFD_TRIANGLES, eFD_COUNT };
 	EFreeDrawPrimitive gCurrentPrimitive = eFD_TRIANGLES;
 	const char* FreeDrawPrimitiveStr[] = { "Lines", "Cirlces", "Ellipses", "Triangles" };
+
+	// Canvas. Finished primitives are rasterized once into the canvas tiles,
+	// the one being edited is drawn on top every frame. Primitive positions
+	// are in canvas space, the view shows canvas point gPan at the bottom
+	// left corner of the window, scaled by gZoom.
+	Rasterizer::SparseCanvas gCanvas;
+	u32		gCommittedCount[eFD_COUNT];		// primitives already in the canvas, per array
+	AEVec2	gPan;
+	f32		gZoom = 1.0f;
+	AEVec2	gLastMouse;
+	const f32 cMinZoom = 1.0f / 8.0f;
+	const f32 cMaxZoom = 8.0f;
+	const f32 cZoomStep = 1.25f;
+
+	// History. Every finished primitive and every clear is one command. A
+	// command keeps the canvas tiles it changed (shared with the canvas, see
+	// SparseCanvas) and the primitives it needs to move back and forth.
+	struct PrimitiveArrays
+	{
+		std::vector<std::pair<AEVec2, f32>> mCircles;
+		std::vector<std::pair<AEVec2, AEVec2>> mEllipses;
+		std::vector<std::pair<AEVec2, AEVec2>> mLines;
+		std::vector<Rasterizer::Vertex> mTriangles;
+	};
+	struct Command
+	{
+		EFreeDrawPrimitive		mType;						// primitive added, eFD_COUNT for a clear
+		u32						mCommitted[eFD_COUNT];		// clear: committed counts before
+		PrimitiveArrays			mPrimitives;				// clear: what was removed. add: the primitive while undone
+		Rasterizer::CanvasDelta	mDelta;
+	};
+	std::deque<Command> gHistory;
+	u32 gHistoryPosition = 0;				// commands applied, the rest can be redone
+	const u32 cMaxHistory = 1000;
 	// ----------------------------------------------------------------------------
 	// FORWARD DECLARATIONS
+	void Undo();
+	void Redo();
+
 	void OptionsMenu()
 	{
 
@@ -61,18 +99,306 @@ namespace FreeDraw {
 		if (ImGui::DragInt("Parametric Precision", &step, 1.0f, 1, 250))
 			Rasterizer::SetCircleParametricPrecision(step);
 
+		// view (right drag pans, mouse wheel zooms)
+		ImGui::SetNextItemWidth(50);
+		ImGui::DragFloat("Zoom", &gZoom, 0.01f, cMinZoom, cMaxZoom);
+		if (ImGui::MenuItem("Reset View")) {
+			gPan = AEVec2(0, 0);
+			gZoom = 1.0f;
+		}
+		ImGui::Text("Canvas Tiles: %u", gCanvas.GetTileCount());
+
+		// history
+		if (ImGui::MenuItem("Undo", "Ctrl+Z", false, gHistoryPosition != 0))
+			Undo();
+		if (ImGui::MenuItem("Redo", "Ctrl+Y", false, gHistoryPosition != gHistory.size()))
+			Redo();
 	}
 
 	// ----------------------------------------------------------------------------
-	// GAMESTATEFUNCTIONS
+	// CANVAS
 
-	void Init()
+	// ----------------------------------------------------------------------------
+	/// \fn		ResetCanvas
+	/// \brief	Removes every primitive and the history.
+	void ResetCanvas()
 	{
 		gLineArray.clear();
 		gCircleArray.clear();
 		gEllipseArray.clear();
 		gTriangleArray.clear();
+		gCanvas.Clear();
+		gCanvas.TakeChanges();
+		for (u32 i = 0; i < eFD_COUNT; ++i)
+			gCommittedCount[i] = 0;
+		gHistory.clear();
+		gHistoryPosition = 0;
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		DrawPrimitive
+	/// \brief	Draws primitive i of the given type, moved by offset and scaled by
+	///			scale. Used both to rasterize into the canvas tiles and to draw
+	///			the primitive being edited on screen.
+	void DrawPrimitive(EFreeDrawPrimitive type, u32 i, const AEVec2& offset, f32 scale)
+	{
+		switch (type) {
+		case eFD_LINES:
+			Rasterizer::DrawLine((gLineArray[i].first + offset) * scale, (gLineArray[i].second + offset) * scale, Rasterizer::Color());
+			break;
+		case eFD_CIRCLES:
+			Rasterizer::DrawCircle((gCircleArray[i].first + offset) * scale, gCircleArray[i].second * scale, Rasterizer::Color());
+			break;
+		case eFD_ELLIPSES:
+			Rasterizer::DrawEllipse((gEllipseArray[i].first + offset) * scale, gEllipseArray[i].second.x * scale, gEllipseArray[i].second.y * scale, Rasterizer::Color());
+			break;
+		case eFD_TRIANGLES: {
+			Rasterizer::Vertex v[3] = { gTriangleArray[i * 3], gTriangleArray[i * 3 + 1], gTriangleArray[i * 3 + 2] };
+			for (auto& vtx : v)
+				vtx.mPosition = (vtx.mPosition + offset) * scale;
+			Rasterizer::DrawTriangle(v[0], v[1], v[2]);
+			// batched outline, naive and DDA draw Bresenham's pixels here
+			AEVec2 outline[3] = { v[0].mPosition, v[1].mPosition, v[2].mPosition };
+			Rasterizer::DrawLineLoop(outline, 3, Rasterizer::Color());
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		GetPrimitiveBounds
+	/// \brief	Canvas space box containing every pixel of the primitive.
+	void GetPrimitiveBounds(EFreeDrawPrimitive type, u32 i, AEVec2& bMin, AEVec2& bMax)
+	{
+		AEVec2 points[3];
+		u32 count = 0;
+		switch (type) {
+		case eFD_LINES:
+			points[count++] = gLineArray[i].first;
+			points[count++] = gLineArray[i].second;
+			break;
+		case eFD_CIRCLES: {
+			AEVec2 r(gCircleArray[i].second, gCircleArray[i].second);
+			points[count++] = gCircleArray[i].first - r;
+			points[count++] = gCircleArray[i].first + r;
+			break;
+		}
+		case eFD_ELLIPSES:
+			points[count++] = gEllipseArray[i].first - gEllipseArray[i].second;
+			points[count++] = gEllipseArray[i].first + gEllipseArray[i].second;
+			break;
+		case eFD_TRIANGLES:
+			for (u32 k = 0; k < 3; ++k)
+				points[count++] = gTriangleArray[i * 3 + k].mPosition;
+			break;
+		default:
+			break;
+		}
+
+		// a couple of pixels of margin for rounding
+		bMin = bMax = points[0];
+		for (u32 k = 1; k < count; ++k) {
+			bMin = AEVec2(min(bMin.x, points[k].x), min(bMin.y, points[k].y));
+			bMax = AEVec2(max(bMax.x, points[k].x), max(bMax.y, points[k].y));
+		}
+		bMin -= AEVec2(2, 2);
+		bMax += AEVec2(2, 2);
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		GetPrimitiveCount
+	/// \brief	Number of primitives of a type.
+	u32 GetPrimitiveCount(EFreeDrawPrimitive type)
+	{
+		switch (type) {
+		case eFD_LINES:		return u32(gLineArray.size());
+		case eFD_CIRCLES:	return u32(gCircleArray.size());
+		case eFD_ELLIPSES:	return u32(gEllipseArray.size());
+		case eFD_TRIANGLES:	return u32(gTriangleArray.size() / 3);
+		default:			return 0;
+		}
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		IsEditing
+	/// \brief	Whether the last primitive of the type still follows the mouse.
+	bool IsEditing(EFreeDrawPrimitive type)
+	{
+		return gCurrentLinePoint != 0 && gCurrentPrimitive == type && GetPrimitiveCount(type) != 0;
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		PushCommand
+	/// \brief	Adds a command after the current one, the undone ones are lost.
+	void PushCommand(Command& cmd)
+	{
+		gHistory.resize(gHistoryPosition);
+		gHistory.push_back(Command());
+		std::swap(gHistory.back(), cmd);
+		if (gHistory.size() > cMaxHistory)
+			gHistory.pop_front();
+		gHistoryPosition = u32(gHistory.size());
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		CommitPrimitives
+	/// \brief	Rasterizes the primitives that are finished and not yet in the
+	///			canvas (everything but the one being edited), one command each.
+	void CommitPrimitives()
+	{
+		for (u32 t = 0; t < eFD_COUNT; ++t) {
+			EFreeDrawPrimitive type = EFreeDrawPrimitive(t);
+			u32 done = GetPrimitiveCount(type) - (IsEditing(type) ? 1 : 0);
+			for (u32 i = gCommittedCount[t]; i < done; ++i) {
+				AEVec2 bMin, bMax;
+				GetPrimitiveBounds(type, i, bMin, bMax);
+				gCanvas.Draw(bMin, bMax, [=](const AEVec2& offset) { DrawPrimitive(type, i, offset, 1.0f); });
+				gCommittedCount[t] = i + 1;
+
+				Command cmd;
+				cmd.mType = type;
+				cmd.mDelta = gCanvas.TakeChanges();
+				PushCommand(cmd);
+			}
+		}
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		CancelEditing
+	/// \brief	Drops the primitive following the mouse, if any.
+	void CancelEditing()
+	{
+		if (IsEditing(gCurrentPrimitive)) {
+			switch (gCurrentPrimitive) {
+			case eFD_LINES:		gLineArray.pop_back(); break;
+			case eFD_CIRCLES:	gCircleArray.pop_back(); break;
+			case eFD_ELLIPSES:	gEllipseArray.pop_back(); break;
+			case eFD_TRIANGLES:	gTriangleArray.resize(gTriangleArray.size() - 3); break;
+			default: break;
+			}
+		}
+		gCurrentLinePoint = 0;
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		SwapPrimitives
+	/// \brief	Exchanges the primitive arrays with the ones of a command.
+	void SwapPrimitives(PrimitiveArrays& arrays)
+	{
+		gCircleArray.swap(arrays.mCircles);
+		gEllipseArray.swap(arrays.mEllipses);
+		gLineArray.swap(arrays.mLines);
+		gTriangleArray.swap(arrays.mTriangles);
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		ClearAll
+	/// \brief	Removes every primitive, as an undoable command. Nothing is
+	///			recorded when there is nothing to clear.
+	void ClearAll()
+	{
+		CancelEditing();
+		if (gCanvas.GetTileCount() == 0 && gLineArray.empty() && gCircleArray.empty() &&
+			gEllipseArray.empty() && gTriangleArray.empty())
+			return;
+
+		Command cmd;
+		cmd.mType = eFD_COUNT;
+		SwapPrimitives(cmd.mPrimitives);
+		for (u32 i = 0; i < eFD_COUNT; ++i) {
+			cmd.mCommitted[i] = gCommittedCount[i];
+			gCommittedCount[i] = 0;
+		}
+		gCanvas.Clear();
+		cmd.mDelta = gCanvas.TakeChanges();
+		PushCommand(cmd);
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		MoveLastPrimitive
+	/// \brief	Moves the last primitive of a type from one set of arrays to the
+	///			end of the other.
+	void MoveLastPrimitive(EFreeDrawPrimitive type, PrimitiveArrays& from, PrimitiveArrays& to)
+	{
+		switch (type) {
+		case eFD_LINES:		to.mLines.push_back(from.mLines.back()); from.mLines.pop_back(); break;
+		case eFD_CIRCLES:	to.mCircles.push_back(from.mCircles.back()); from.mCircles.pop_back(); break;
+		case eFD_ELLIPSES:	to.mEllipses.push_back(from.mEllipses.back()); from.mEllipses.pop_back(); break;
+		case eFD_TRIANGLES:
+			to.mTriangles.insert(to.mTriangles.end(), from.mTriangles.end() - 3, from.mTriangles.end());
+			from.mTriangles.resize(from.mTriangles.size() - 3);
+			break;
+		default: break;
+		}
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		Undo
+	/// \brief	Reverts the last applied command. An unfinished primitive is
+	///			dropped first.
+	void Undo()
+	{
+		CancelEditing();
+		if (gHistoryPosition == 0)
+			return;
+
+		Command& cmd = gHistory[--gHistoryPosition];
+		gCanvas.Undo(cmd.mDelta);
+
+		// clear: put back everything that was removed
+		if (cmd.mType == eFD_COUNT) {
+			SwapPrimitives(cmd.mPrimitives);
+			for (u32 i = 0; i < eFD_COUNT; ++i)
+				gCommittedCount[i] = cmd.mCommitted[i];
+			return;
+		}
+
+		// added primitive: it is the last one of its type, keep it for redo
+		PrimitiveArrays current;
+		SwapPrimitives(current);
+		MoveLastPrimitive(cmd.mType, current, cmd.mPrimitives);
+		SwapPrimitives(current);
+		--gCommittedCount[cmd.mType];
+	}
+
+	// ----------------------------------------------------------------------------
+	/// \fn		Redo
+	/// \brief	Applies the next undone command again.
+	void Redo()
+	{
+		CancelEditing();
+		if (gHistoryPosition == gHistory.size())
+			return;
+
+		Command& cmd = gHistory[gHistoryPosition++];
+		gCanvas.Redo(cmd.mDelta);
+
+		if (cmd.mType == eFD_COUNT) {
+			SwapPrimitives(cmd.mPrimitives);
+			for (u32 i = 0; i < eFD_COUNT; ++i)
+				gCommittedCount[i] = 0;
+			return;
+		}
+
+		PrimitiveArrays current;
+		SwapPrimitives(current);
+		MoveLastPrimitive(cmd.mType, cmd.mPrimitives, current);
+		SwapPrimitives(current);
+		++gCommittedCount[cmd.mType];
+	}
+
+	// ----------------------------------------------------------------------------
+	// GAMESTATEFUNCTIONS
+
+	void Init()
+	{
+		ResetCanvas();
 		gCurrentLinePoint = 0;
+		gPan = AEVec2(0, 0);
+		gZoom = 1.0f;
+		gLastMouse = gAEMousePosition;
 	}
 	void Update()
 	{
@@ -81,15 +407,34 @@ namespace FreeDraw {
 
 		// clear all primitives
 		if (AEInputKeyTriggered('C'))
-		{
-			gLineArray.clear();
-			gCircleArray.clear();
-			gEllipseArray.clear();
-			gTriangleArray.clear();
-		}
+			ClearAll();
+
+		// history
+		if (AEInputKeyPressed(AE_KEY_CTRL) && AEInputKeyTriggered('Z'))
+			Undo();
+		if (AEInputKeyPressed(AE_KEY_CTRL) && AEInputKeyTriggered('Y'))
+			Redo();
 
 		// current the mouse position to frame buffer space (origin at botleft)
-		AEVec2 mouseVP = gAEMousePosition + AEVec2((f32)gAESysWinWidth / 2.0f, (f32)gAESysWinHeight / 2.0f);
+		AEVec2 mouseFB = gAEMousePosition + AEVec2((f32)gAESysWinWidth / 2.0f, (f32)gAESysWinHeight / 2.0f);
+
+		// pan and zoom, keeping the canvas point under the mouse in place
+		if (!isGuiActive) {
+			if (AEInputMousePressed(AE_MOUSE_RIGHT))
+				gPan -= (gAEMousePosition - gLastMouse) / gZoom;
+
+			f32 wheel = AEInputGetMouseWheel();
+			if (wheel != 0.0f) {
+				AEVec2 anchor = gPan + mouseFB / gZoom;
+				gZoom = wheel > 0.0f ? gZoom * cZoomStep : gZoom / cZoomStep;
+				gZoom = max(cMinZoom, min(gZoom, cMaxZoom));
+				gPan = anchor - mouseFB / gZoom;
+			}
+		}
+		gLastMouse = gAEMousePosition;
+
+		// mouse position in canvas space
+		AEVec2 mouseVP = gPan + mouseFB / gZoom;
 
 		// create primitives with the mouse, unless the gui is active.
 		if (!isGuiActive) {
@@ -160,32 +505,25 @@ namespace FreeDraw {
 				}
 			}
 		}
+
+		// rasterize what was finished this frame
+		CommitPrimitives();
 	}
 	void Render()
 	{
-		Rasterizer::FrameBuffer::Clear(Rasterizer::Color(1.0f, 1.0f, 1.0f, 1.0f));
-
-		// render all the lines
-		for (auto& line : gLineArray)
-			Rasterizer::DrawLine(line.first, line.second, Rasterizer::Color());
+		// finished primitives, from the canvas tiles
+		gCanvas.Present(gPan, gZoom);
 
-		// render all the circles
-		for (auto& circle : gCircleArray)
-			Rasterizer::DrawCircle(circle.first, circle.second, Rasterizer::Color());
-
-		// render all the ellipses
-		for (auto& ellipse : gEllipseArray)
-			Rasterizer::DrawEllipse(ellipse.first, ellipse.second.x, ellipse.second.y, Rasterizer::Color());
-
-		// render all triangles
-		for (u32 i = 0; i < gTriangleArray.size(); i += 3) {
-			Rasterizer::DrawTriangle(gTriangleArray[i], gTriangleArray[i + 1], gTriangleArray[i + 2]);
-			Rasterizer::DrawLine(gTriangleArray[i].mPosition, gTriangleArray[i + 1].mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(gTriangleArray[i + 1].mPosition, gTriangleArray[i + 2].mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(gTriangleArray[i].mPosition, gTriangleArray[i + 2].mPosition, Rasterizer::Color());
-
-		}
+		// primitive being edited
+		if (IsEditing(gCurrentPrimitive))
+			DrawPrimitive(gCurrentPrimitive, GetPrimitiveCount(gCurrentPrimitive) - 1, -gPan, gZoom);
 
 		Rasterizer::FrameBuffer::Present();
 	}
+	void Free()
+	{
+		// the canvas tiles go back to the aligned pool now, not at static
+		// destruction (the pool may already be gone by then)
+		ResetCanvas();
+	}
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ namespace FreeDraw {
 	void Init();
 	void Update();
 	void Render();
+	void Free();
 }
 namespace SimpleCircles {
 	void Init();
@@ -14,7 +14,7 @@ namespace PlaneNormalDemo
 	void Render()
 	{
 		u32 checker[2] = { AE_COLORS_GRAY, AE_COLORS_ANTI_FLASH_WHITE };
-		Rasterizer::FrameBuffer::Clear(Rasterizer::Color().FromU32(checker[0]));
+		Rasterizer::FrameBuffer::ClearCheckerboard(checker, 32);
 		
 		// TODO: Insert CODE HERE
 
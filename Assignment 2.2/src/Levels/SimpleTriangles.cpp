@@ -104,10 +104,8 @@ namespace SimpleTriangles
 		// Draw Outline
 		if (gDebug)
 		{
-			Rasterizer::DrawLine(AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p2.x, p2.y), AEVec2(p3.x, p3.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p0.x, p0.y), AEVec2(p3.x, p3.y), Rasterizer::Color());
+			AEVec2 outline[4] = { AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y), AEVec2(p3.x, p3.y) };
+			Rasterizer::DrawLineLoop(outline, 4, Rasterizer::Color());
 		}
 		// use naive
 		if (gMode == 0)
@@ -148,10 +146,8 @@ namespace SimpleTriangles
 		// Draw Outline
 		if (gDebug)
 		{
-			Rasterizer::DrawLine(AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p2.x, p2.y), AEVec2(p3.x, p3.y), Rasterizer::Color());
-			Rasterizer::DrawLine(AEVec2(p0.x, p0.y), AEVec2(p3.x, p3.y), Rasterizer::Color());
+			AEVec2 outline[4] = { AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y), AEVec2(p3.x, p3.y) };
+			Rasterizer::DrawLineLoop(outline, 4, Rasterizer::Color());
 		}
 		// use naive
 		if (gMode == 0)
@@ -204,9 +200,8 @@ namespace SimpleTriangles
 			// Draw Outline
 			if (gDebug)
 			{
-				Rasterizer::DrawLine(AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), Rasterizer::Color());
-				Rasterizer::DrawLine(AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y), Rasterizer::Color());
-				Rasterizer::DrawLine(AEVec2(p2.x, p2.y), AEVec2(p0.x, p0.y), Rasterizer::Color());
+				AEVec2 outline[3] = { AEVec2(p0.x, p0.y), AEVec2(p1.x, p1.y), AEVec2(p2.x, p2.y) };
+				Rasterizer::DrawLineLoop(outline, 3, Rasterizer::Color());
 			}
 			// use naive
 			if (gMode == 0)
@@ -233,9 +228,8 @@ namespace SimpleTriangles
 		Rasterizer::DrawTriangle(v0, v1, v2);
 		if (gDebug)
 		{
-			Rasterizer::DrawLine(v0.mPosition, v1.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v0.mPosition, v2.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v1.mPosition, v2.mPosition, Rasterizer::Color());
+			AEVec2 outline[3] = { v0.mPosition, v1.mPosition, v2.mPosition };
+			Rasterizer::DrawLineLoop(outline, 3, Rasterizer::Color());
 		}
 	}
 	// Render simple quad rotate by 45 deg
@@ -250,10 +244,8 @@ namespace SimpleTriangles
 		// Draw Outline
 		if (gDebug)
 		{
-			Rasterizer::DrawLine(v0.mPosition, v1.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v1.mPosition, v2.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v2.mPosition, v3.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v0.mPosition, v3.mPosition, Rasterizer::Color());
+			AEVec2 outline[4] = { v0.mPosition, v1.mPosition, v2.mPosition, v3.mPosition };
+			Rasterizer::DrawLineLoop(outline, 4, Rasterizer::Color());
 		}
 		Rasterizer::DrawTriangle(v0, v1, v2);
 		Rasterizer::DrawTriangle(v0, v2, v3);
@@ -285,10 +277,8 @@ namespace SimpleTriangles
 		// Draw Outline
 		if (gDebug)
 		{
-			Rasterizer::DrawLine(v0.mPosition, v1.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v1.mPosition, v2.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v2.mPosition, v3.mPosition, Rasterizer::Color());
-			Rasterizer::DrawLine(v0.mPosition, v3.mPosition, Rasterizer::Color());
+			AEVec2 outline[4] = { v0.mPosition, v1.mPosition, v2.mPosition, v3.mPosition };
+			Rasterizer::DrawLineLoop(outline, 4, Rasterizer::Color());
 		}
 		Rasterizer::DrawTriangle(v0, v1, v2);
 		Rasterizer::DrawTriangle(v0, v2, v3);
@@ -331,9 +321,8 @@ namespace SimpleTriangles
 			// Draw Outline
 			if (gDebug)
 			{
-				Rasterizer::DrawLine(p0.mPosition, p1.mPosition, Rasterizer::Color());
-				Rasterizer::DrawLine(p0.mPosition, p2.mPosition, Rasterizer::Color());
-				Rasterizer::DrawLine(p1.mPosition, p2.mPosition, Rasterizer::Color());
+				AEVec2 outline[3] = { p0.mPosition, p1.mPosition, p2.mPosition };
+				Rasterizer::DrawLineLoop(outline, 3, Rasterizer::Color());
 			}
 
 			Rasterizer::DrawTriangle(p0, p1, p2);
@@ -22,7 +22,7 @@ namespace StressTests {
 			points[i + 1] = p1;
 		}
 
-		f64 timeDDA, timeNaive, timeBresenham;
+		f64 timeDDA, timeNaive, timeBresenham, timeRunSlice, timeDoubleStep, timeWu, timeBatched;
 
 		Rasterizer::Color c;
 		// do stress test comparison
@@ -41,9 +41,39 @@ namespace StressTests {
 			Rasterizer::DrawLineBresenham(points[i], points[i + 1], c);
 		timeBresenham = AEGetTime() - s;
 
+		s = AEGetTime();
+		for (u32 i = 0; i < points.size(); i += 2)
+			Rasterizer::DrawLineRunSlice(points[i], points[i + 1], c);
+		timeRunSlice = AEGetTime() - s;
+
+		s = AEGetTime();
+		for (u32 i = 0; i < points.size(); i += 2)
+			Rasterizer::DrawLineDoubleStep(points[i], points[i + 1], c);
+		timeDoubleStep = AEGetTime() - s;
+
+		s = AEGetTime();
+		for (u32 i = 0; i < points.size(); i += 2)
+			Rasterizer::DrawLineWu(points[i], points[i + 1], c);
+		timeWu = AEGetTime() - s;
+
+		// same lines in one batched call (current line method)
+		std::vector<AEVec2> starts(lineCount), ends(lineCount);
+		for (int i = 0; i < lineCount; ++i)
+		{
+			starts[i] = points[i * 2];
+			ends[i] = points[i * 2 + 1];
+		}
+		s = AEGetTime();
+		Rasterizer::DrawLines(starts.data(), ends.data(), lineCount, c);
+		timeBatched = AEGetTime() - s;
+
 		std::cout << "Naive Time: " << timeNaive << "\n";
 		std::cout << "DDA Time: " << timeDDA << "\n";
 		std::cout << "Bresenham Time: " << timeBresenham << "\n";
+		std::cout << "Run Slice Time: " << timeRunSlice << "\n";
+		std::cout << "Double Step Time: " << timeDoubleStep << "\n";
+		std::cout << "Wu Time: " << timeWu << "\n";
+		std::cout << "Batched Time: " << timeBatched << "\n";
 	}
 	void StressTestCircles()
 	{
@@ -130,11 +160,46 @@ namespace StressTests {
 		std::cout << "Ellipse Parametric Incremental Time: " << timeParametricInc << "\n";
 		std::cout << "Ellipse Midpoint Time: " << timeMidpoint << "\n";
 	}
+	void StressTestStrokes()
+	{
+		AESysShowConsole();
+		int strokeCount = 100000;
+		const u32 pointsPerStroke = 8;
+		std::vector<AEVec2> points(strokeCount * pointsPerStroke);
+		// random polylines contained within the viewport
+		for (u32 i = 0; i < points.size(); ++i)
+			points[i] = AEVec2(AERandFloat(0, (f32)gAESysWinWidth), AERandFloat(0, (f32)gAESysWinHeight));
+
+		const char* capNames[] = { "Butt", "Square", "Round" };
+		const char* joinNames[] = { "Miter", "Round", "Bevel" };
+
+		Rasterizer::Color c;
+		// thick lines with every cap
+		for (int cap = eSC_BUTT; cap <= eSC_ROUND; ++cap)
+		{
+			StrokeStyle style(5.0f, eSJ_MITER, EStrokeCap(cap));
+			auto s = AEGetTime();
+			for (u32 i = 0; i < points.size(); i += 2)
+				Rasterizer::DrawThickLine(points[i], points[i + 1], style, c);
+			std::cout << "Thick Line " << capNames[cap] << " Cap Time: " << AEGetTime() - s << "\n";
+		}
+
+		// closed polylines with every join
+		for (int join = eSJ_MITER; join <= eSJ_BEVEL; ++join)
+		{
+			StrokeStyle style(5.0f, EStrokeJoin(join));
+			auto s = AEGetTime();
+			for (u32 i = 0; i < points.size(); i += pointsPerStroke)
+				Rasterizer::DrawPolyline(&points[i], pointsPerStroke, style, c, true);
+			std::cout << "Polyline " << joinNames[join] << " Join Time: " << AEGetTime() - s << "\n";
+		}
+	}
 	void Load()
 	{
 		StressTestLines();
 		StressTestCircles();
 		StressTestEllipses();
+		StressTestStrokes();
 	}
 	void Update()
 	{
@@ -1,5 +1,7 @@
 #include <AEEngine.h>
 #include "Engine\Rasterizer\Rasterizer.h"
+#include "Engine\Utils\ParallelFor.h"
+#include "Engine\Utils\AlignedPool.h"
 #include "Levels\GameStates.h"
 #include "Levels\Common.h"
 
@@ -12,6 +14,8 @@ int main()
 	}
 
 	// initialize graphics system
+	// (large pages need the "lock pages in memory" privilege, normal pages otherwise)
+	AlignedPoolSetLargePages(true);
 	if (!Rasterizer::FrameBuffer::Allocate(gAESysWinWidth, gAESysWinHeight))
 		return 0;
 
@@ -30,7 +34,7 @@ int main()
 		FreeDraw::Init,
 		FreeDraw::Update,
 		FreeDraw::Render,
-		0,
+		FreeDraw::Free,
 		0);
 	AEGameStateMgrAdd(
 		GS_SIMPLE_CIRCLES,
@@ -80,7 +84,12 @@ int main()
 	AESysGameLoop();
 
 	// Terminate Graphics System
+	// (free draw keeps pooled tiles in globals, release them before the
+	// pool is trimmed even if the loop exited without freeing the state)
+	FreeDraw::Free();
 	Rasterizer::FrameBuffer::Delete();
+	AlignedPoolTrim();
+	ParallelShutdown();
 
 	// Terminate AECore
 	AESysExit();